@@ -16,6 +16,7 @@ int main(int argc, char* argv[]) {
   
   const double MinAlpha = Env.GetIfArgPrefixFlt("-la:", 0.05, "Min alpha (default:0.05)\n");
   const double MaxAlpha = Env.GetIfArgPrefixFlt("-ua:", 100, "Maximum alpha (default:100)\n");
+  const bool SaveBin = Env.GetIfArgPrefixInt("-b:", 0, "Also save the cascades in binary format to <-o:>-cascades.bin, 0:no, 1:yes (default:0)\n")==1;
 
   TStrFltFltHNEDNet GroundTruth;
   THash<TInt, TCascade> CascH;
@@ -29,19 +30,16 @@ int main(int argc, char* argv[]) {
 
   // load cascades from file
   printf("\nLoading input cascades: %s\n", InFNm.CStr());
-  TFIn FIn(InFNms[0]);
-  InfoPathFileIO::LoadCascadesTxt(FIn, CascH, nodeInfo);
+  InfoPathFileIO::LoadCascadesTxt(InFNms[0], CascH, nodeInfo);
  
   for (int i=1;i<InFNms.Len();i++) {
      printf("%s\n", InFNms[i].CStr());
-     TFIn FIn(InFNms[i]);
-     InfoPathFileIO::AddCascadesTxt(FIn, CascH, nodeInfo);
+     InfoPathFileIO::AddCascadesTxt(InFNms[i], CascH, nodeInfo);
   }
 
   printf("\nLoading input networks: %s\n", GroundTruthFNm.CStr());
   // load ground truth network
-  TFIn FGIn(GTFNms[0]);
-  InfoPathFileIO::LoadNetworkTxt(FGIn, GroundTruth, nodeInfo);
+  InfoPathFileIO::LoadNetworkTxt(GTFNms[0], GroundTruth, nodeInfo);
   
   for (int i=1;i<GTFNms.Len();i++) {
      printf("%s\n", GTFNms[i].CStr());
@@ -52,6 +50,11 @@ int main(int argc, char* argv[]) {
   // Save inferred network in a file
   InfoPathFileIO::SaveNetwork(TStr::Fmt("%s-network.txt", OutFNm.CStr()), GroundTruth, nodeInfo, edgeInfo);
   InfoPathFileIO::SaveCascades(TStr::Fmt("%s-cascades.txt",OutFNm.CStr()), CascH, nodeInfo); 
+  if (SaveBin) {
+     CascadeStore cascades;
+     cascades.Pack(CascH, nodeInfo.NodeNmH);
+     InfoPathFileIO::SaveCascadesBin(TStr::Fmt("%s-cascades.bin",OutFNm.CStr()), cascades, nodeInfo);
+  }
  
   Catch
   printf("\nrun time: %s (%s)\n", ExeTm.GetTmStr(), TSecTm::GetCurTm().GetTmStr().CStr());
@@ -10,6 +10,7 @@ int main(int argc, char* argv[]) {
   bool verbose = true;
 
   const TStr InFNm  = Env.GetIfArgPrefixStr("-i:", "example-cascades.txt", "Input cascades");
+  const int InputFormat = Env.GetIfArgPrefixInt("-if:", 0, "Input cascades format. 0:text, 1:binary, as written by DataMerger -b: (default:0)\n");
   const TStr GroundTruthFNm = Env.GetIfArgPrefixStr("-n:", "example-network.txt", "Input ground-truth network");
   const TStr OutFNm  = Env.GetIfArgPrefixStr("-o:", "network", "Output file name(s) prefix");
 
@@ -27,6 +28,8 @@ int main(int argc, char* argv[]) {
 
   double Window = Env.GetIfArgPrefixFlt("-h:", -1, "Time window per cascade (if any), -1 means the window is set by  means last infection time (default:-1)\n");
   double observedWindow = Env.GetIfArgPrefixFlt("-w:", 10.0, "Observed window time default(10.0)\n");
+  const int SurvivalKernel = Env.GetIfArgPrefixInt("-sk:", 0, "Survival term kernel\n0:all nodes, 1:potential out-edges of the cascade nodes (default:0)\n");
+  const int MinCoOccurrence = Env.GetIfArgPrefixInt("-mc:", 1, "Minimum number of cascades in which a pair must co-occur to become a potential edge (default:1)\n");
 
   const TStr NodeIdx = Env.GetIfArgPrefixStr("-ni:", "-1", "Node indeces to estimate incoming tx rates (-1:all nodes, -X:random -X-node subset)");
 
@@ -34,6 +37,11 @@ int main(int argc, char* argv[]) {
   const int Iters  = Env.GetIfArgPrefixInt("-e:", 1000, "Number of iterations per time step");
   const int BatchLen = Env.GetIfArgPrefixInt("-bl:", 1, "Number of cascades for each batch, -t:2 & -t:4 (default:1000)");
   const TStr ParamSampling = Env.GetIfArgPrefixStr("-sd:", "0.1", "Params for -t:1,2 & -t:4,5 (default:0.1)\n");
+  const int Epochs = Env.GetIfArgPrefixInt("-ep:", 0, "Shuffle the cascades once per epoch and take the batches in that order, instead of drawing them with -t:\n0:no, 1:yes (default:0)\n");
+  const TOptimizer OptimizerType = (TOptimizer)Env.GetIfArgPrefixInt("-op:", 0, "Update rule of the gradient steps, with the per-edge state kept next to the alphas\n0:SGD, 1:AdaGrad, 2:RMSProp, 3:Adam (default:0)\n");
+  const int Async = Env.GetIfArgPrefixInt("-as:", 0, "Asynchronous lock-free updates, trades determinism for throughput\n0:no, 1:yes (default:0)\n");
+  // the asynchronous updates draw cascades with -t: and take plain SGD steps
+  if (Async==1 && (Epochs==1 || OptimizerType!=SGD_OPTIMIZER)) { FailR("Bad -as: parameter, -as:1 needs -ep:0 and -op:0."); }
 
   const double lr = Env.GetIfArgPrefixFlt("-g:", 0.001, "Alpha for gradient descend (default:0.01)\n");
   const double Aging = Env.GetIfArgPrefixFlt("-a:", 1.0, "Aging factor for non-used edges (default:1.0)\n");
@@ -55,6 +63,9 @@ int main(int argc, char* argv[]) {
   infoPathModel.SetBatchSize(BatchLen);
   infoPathModel.SetLearningRate(lr);
   infoPathModel.SetParamSampling(ParamSampling);
+  infoPathModel.SetEpochs(Epochs==1);
+  infoPathModel.SetOptimizer(OptimizerType);
+  infoPathModel.SetAsync(Async==1);
 
   infoPathModel.SetTolerance(Tol);
   infoPathModel.SetMaxAlpha(MaxAlpha);
@@ -64,10 +75,13 @@ int main(int argc, char* argv[]) {
   infoPathModel.SetMu(Mu);
   infoPathModel.SetWindow(Window);
   infoPathModel.SetObservedWindow(observedWindow);
+  infoPathModel.SetSparseSurvival(SurvivalKernel==1);
+  infoPathModel.SetMinCoOccurrence(MinCoOccurrence);
   infoPathModel.SetAging(Aging);
 
   // load cascades from file
-  infoPathModel.LoadCascadesTxt(InFNm);
+  if (InputFormat==1) { infoPathModel.LoadCascadesBin(InFNm); }
+  else { infoPathModel.LoadCascadesTxt(InFNm); }
   
   printf("cascades:%d\nRunning Stochastic Network Inference..\n", infoPathModel.GetCascs());
 
@@ -77,8 +91,8 @@ int main(int argc, char* argv[]) {
   if (MaxTimeStr.EqI("-1")) {
     // find maximum time across cascades
     for (int i=0; i<infoPathModel.GetCascs(); i++) {
-      if (infoPathModel.CascH[i].GetMaxTm() > MaxTime) {
-        MaxTime = infoPathModel.CascH[i].GetMaxTm();
+      if (infoPathModel.CascStore.GetMaxTm(i) > MaxTime) {
+        MaxTime = infoPathModel.CascStore.GetMaxTm(i);
       }
     }
   } else {
@@ -92,8 +106,8 @@ int main(int argc, char* argv[]) {
     // find minimum time across cascades
     MinTime = TFlt::Mx;
     for (int i=0; i<infoPathModel.GetCascs(); i++) {
-      if (infoPathModel.CascH[i].GetMinTm() < MinTime && infoPathModel.CascH[i].GetMinTm()!=0) {
-        MinTime = infoPathModel.CascH[i].GetMinTm();
+      if (infoPathModel.CascStore.GetMinTm(i) < MinTime && infoPathModel.CascStore.GetMinTm(i)!=0) {
+        MinTime = infoPathModel.CascStore.GetMinTm(i);
       }
     }
   } else {
@@ -135,8 +149,8 @@ int main(int argc, char* argv[]) {
         // copy infections
         if (verbose) { printf("Generating infections vector...\n"); }
         for (int i=0; i<infoPathModel.GetCascs(); i++) {
-          for (int j=0; j<infoPathModel.CascH[i].Len() && infoPathModel.CascH[i].NIdHitH[j].Tm < MaxTime; j++) {
-            InfectionsV.Add(infoPathModel.CascH[i].NIdHitH[j].Tm);
+          for (int hit=infoPathModel.CascStore.GetBeg(i); hit<infoPathModel.CascStore.GetEnd(i) && infoPathModel.CascStore.GetTm(hit) < MaxTime; hit++) {
+            InfectionsV.Add(infoPathModel.CascStore.GetTm(hit));
           }
         }
 
@@ -157,7 +171,7 @@ int main(int argc, char* argv[]) {
 
       case CASCADE_STEP:
         for (int i=0; i<infoPathModel.GetCascs(); i++) {
-          if (infoPathModel.CascH[i].GetMaxTm()<MinTime+MaxTime) { Steps.Add(infoPathModel.CascH[i].GetMaxTm()); }
+          if (infoPathModel.CascStore.GetMaxTm(i)<MinTime+MaxTime) { Steps.Add(infoPathModel.CascStore.GetMaxTm(i)); }
         }
 
         Steps.Sort();
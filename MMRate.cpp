@@ -10,8 +10,10 @@ int main(int argc, char* argv[]) {
   bool verbose = true;
 
   const TStr InFNm  = Env.GetIfArgPrefixStr("-i:", "example-cascades.txt", "Input cascades");
+  const int InputFormat = Env.GetIfArgPrefixInt("-if:", 0, "Input cascades format. 0:text, 1:binary, as written by DataMerger -b: (default:0)\n");
   const TStr GroundTruthFNm = Env.GetIfArgPrefixStr("-n:", "example-network.txt", "Input ground-truth network");
   const TStr OutFNm  = Env.GetIfArgPrefixStr("-o:", "network", "Output file name(s) prefix");
+  const bool BinaryEdges = Env.GetIfArgPrefixInt("-ob:", 0, "Also write every topic network as a binary edge list <file>.bin, 0:no, 1:yes (default:0)\n")==1;
 
   const TModel Model = (TModel)Env.GetIfArgPrefixInt("-m:", 0, "0:exponential, 1:power law, 2:rayleigh, 3:weibull");
   const double Delta = Env.GetIfArgPrefixFlt("-d:", 1.0, "Delta for power-law (default:1)\n"); // delta for power law
@@ -30,6 +32,8 @@ int main(int argc, char* argv[]) {
 
   double Window = Env.GetIfArgPrefixFlt("-h:", -1, "Time window per cascade (if any), -1 means the window is set by  means last infection time (default:-1)\n");
   double observedWindow = Env.GetIfArgPrefixFlt("-w:", 10.0, "Observed time window (default 10.0)\n");
+  const int SurvivalKernel = Env.GetIfArgPrefixInt("-sk:", 0, "Survival term kernel\n0:all nodes, 1:potential out-edges of the cascade nodes (default:0)\n");
+  const int MinCoOccurrence = Env.GetIfArgPrefixInt("-mc:", 1, "Minimum number of cascades in which a pair must co-occur to become a potential edge (default:1)\n");
 
   const TStr NodeIdx = Env.GetIfArgPrefixStr("-ni:", "-1", "Node indeces to estimate incoming tx rates (-1:all nodes, -X:random -X-node subset)");
 
@@ -38,6 +42,8 @@ int main(int argc, char* argv[]) {
   const int EMIters  = Env.GetIfArgPrefixInt("-em:", 5, "Number of iterations of expectation maximization");
   const int BatchLen = Env.GetIfArgPrefixInt("-bl:", 1, "Number of cascades for each batch, -t:2 & -t:4 (default:1000)");
   const TStr ParamSampling = Env.GetIfArgPrefixStr("-sd:", "0.1", "Params for -t:1,2 & -t:4,5 (default:0.1)\n");
+  const int Epochs = Env.GetIfArgPrefixInt("-ep:", 0, "Shuffle the cascades once per epoch and take the batches in that order, instead of drawing them with -t:\n0:no, 1:yes (default:0)\n");
+  const TOptimizer OptimizerType = (TOptimizer)Env.GetIfArgPrefixInt("-op:", 0, "Update rule of the gradient steps, with the per-edge state kept next to the alphas\n0:SGD, 1:AdaGrad, 2:RMSProp, 3:Adam (default:0)\n");
 
   const double lr = Env.GetIfArgPrefixFlt("-g:", 0.001, "Alpha for gradient descend (default:0.01)\n");
   const double Aging = Env.GetIfArgPrefixFlt("-a:", 1.0, "Aging factor for non-used edges (default:1.0)\n");
@@ -69,6 +75,8 @@ int main(int argc, char* argv[]) {
   mMRate.SetBatchSize(BatchLen);
   mMRate.SetLearningRate(lr);
   mMRate.SetParamSampling(ParamSampling);
+  mMRate.SetEpochs(Epochs==1);
+  mMRate.SetOptimizer(OptimizerType);
 
   mMRate.SetLatentVariableSize(latentVariableSize);
   mMRate.SetTolerance(Tol);
@@ -81,11 +89,15 @@ int main(int argc, char* argv[]) {
   mMRate.SetRegularizer(Regularizer);
   mMRate.SetMu(Mu);
   mMRate.SetWindow(Window);
+  mMRate.SetBinaryEdges(BinaryEdges);
   mMRate.SetObservedWindow(observedWindow);
+  mMRate.SetSparseSurvival(SurvivalKernel==1);
+  mMRate.SetMinCoOccurrence(MinCoOccurrence);
   mMRate.SetAging(Aging);
 
   // load cascades from file
-  mMRate.LoadCascadesTxt(InFNm);
+  if (InputFormat==1) { mMRate.LoadCascadesBin(InFNm); }
+  else { mMRate.LoadCascadesTxt(InFNm); }
   
   printf("cascades:%d\nRunning Stochastic Network Inference..\n", mMRate.GetCascs());
 
@@ -95,8 +107,8 @@ int main(int argc, char* argv[]) {
   if (MaxTimeStr.EqI("-1")) {
     // find maximum time across cascades
     for (int i=0; i<mMRate.GetCascs(); i++) {
-      if (mMRate.CascH[i].GetMaxTm() > MaxTime) {
-        MaxTime = mMRate.CascH[i].GetMaxTm();
+      if (mMRate.CascStore.GetMaxTm(i) > MaxTime) {
+        MaxTime = mMRate.CascStore.GetMaxTm(i);
       }
     }
   } else {
@@ -110,8 +122,8 @@ int main(int argc, char* argv[]) {
     // find minimum time across cascades
     MinTime = TFlt::Mx;
     for (int i=0; i<mMRate.GetCascs(); i++) {
-      if (mMRate.CascH[i].GetMinTm() < MinTime && mMRate.CascH[i].GetMinTm()!=0) {
-        MinTime = mMRate.CascH[i].GetMinTm();
+      if (mMRate.CascStore.GetMinTm(i) < MinTime && mMRate.CascStore.GetMinTm(i)!=0) {
+        MinTime = mMRate.CascStore.GetMinTm(i);
       }
     }
   } else {
@@ -153,8 +165,8 @@ int main(int argc, char* argv[]) {
         // copy infections
         if (verbose) { printf("Generating infections vector...\n"); }
         for (int i=0; i<mMRate.GetCascs(); i++) {
-          for (int j=0; j<mMRate.CascH[i].Len() && mMRate.CascH[i].NIdHitH[j].Tm < MaxTime; j++) {
-            InfectionsV.Add(mMRate.CascH[i].NIdHitH[j].Tm);
+          for (int hit=mMRate.CascStore.GetBeg(i); hit<mMRate.CascStore.GetEnd(i) && mMRate.CascStore.GetTm(hit) < MaxTime; hit++) {
+            InfectionsV.Add(mMRate.CascStore.GetTm(hit));
           }
         }
 
@@ -175,7 +187,7 @@ int main(int argc, char* argv[]) {
 
       case CASCADE_STEP:
         for (int i=0; i<mMRate.GetCascs(); i++) {
-          if (mMRate.CascH[i].GetMaxTm()<MinTime+MaxTime) { Steps.Add(mMRate.CascH[i].GetMaxTm()); }
+          if (mMRate.CascStore.GetMaxTm(i)<MinTime+MaxTime) { Steps.Add(mMRate.CascStore.GetMaxTm(i)); }
         }
 
         Steps.Sort();
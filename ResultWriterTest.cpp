@@ -0,0 +1,168 @@
+#include "stdafx.h"
+#include <ResultWriter.h>
+#include <AsyncNetworkWriter.h>
+#include <InfoPathFileIO.h>
+
+// Checks that ResultWriter, and the writers built on it, write the same
+// bytes as the TStr::Fmt output they replace. Exits with 1 when any value differs.
+
+static TStr ReadFile(const TStr& FNm) {
+  FILE *file = fopen(FNm.CStr(), "rb");
+  EAssertR(file != NULL, TStr::Fmt("Can not open %s", FNm.CStr()));
+  TChA Contents;
+  char bf[1 << 16];
+  size_t len;
+  while ((len = fread(bf, 1, sizeof(bf), file)) > 0) { for (size_t i=0; i<len; i++) Contents += bf[i]; }
+  fclose(file);
+  return Contents;
+}
+
+// Prints the first few differing lines and returns the number of them.
+static int CompareLines(const char *name, const TStr& Written, const TStr& Expected) {
+  TStrV WrittenV, ExpectedV;
+  Written.SplitOnAllCh('\n', WrittenV, false);
+  Expected.SplitOnAllCh('\n', ExpectedV, false);
+  int diffNm = WrittenV.Len() == ExpectedV.Len() ? 0 : 1;
+  for (int i=0; i<TMath::Mn(WrittenV.Len(), ExpectedV.Len()); i++) {
+    if (WrittenV[i] == ExpectedV[i]) { continue; }
+    if (diffNm < 5) { printf("  %s line %d: %s, expected %s\n", name, i, WrittenV[i].CStr(), ExpectedV[i].CStr()); }
+    diffNm++;
+  }
+  printf("%s: %d lines, %d differ\n", name, ExpectedV.Len(), diffNm);
+  return diffNm;
+}
+
+// PutFlt against "%f" on values at and around the .5 boundaries of the sixth
+// decimal, on exact binary ties and on values over the whole double range.
+static int TestPutFlt(const TStr& OutFNm) {
+  TFltV Vals;
+  TRnd Rnd(1);
+  char Str[64];
+  for (int i=0; i<200000; i++) {
+    // x.xxxxxx5 and its neighbours
+    snprintf(Str, sizeof(Str), "%d.%06d5", Rnd.GetUniDevInt(100000), Rnd.GetUniDevInt(1000000));
+    double val = atof(Str);
+    Vals.Add(val); Vals.Add(nextafter(val, 0.0)); Vals.Add(nextafter(val, 1e300));
+    Vals.Add(-val);
+    // seven decimals
+    Vals.Add(floor(Rnd.GetUniDev() * 1e9) / 1e7);
+  }
+  // (2k+1)/2^7 has a sixth decimal of exactly .5, so these are printf's ties
+  for (int k=0; k<2000; k++) { Vals.Add((2*k+1) / 128.0); Vals.Add(-(2*k+1) / 128.0); }
+  for (int i=0; i<100000; i++) { Vals.Add((Rnd.GetUniDev() - 0.5) * pow(10.0, Rnd.GetUniDevInt(40) - 20)); }
+  const double Extra[] = { 57.207839499999999, 0.0, -0.0, 4.9e-324, -1e-7, 4294967295.9999995, 4294967296.0000005, 1e300, -1e300, INFINITY, -INFINITY, NAN };
+  for (int i=0; i<int(sizeof(Extra)/sizeof(Extra[0])); i++) { Vals.Add(Extra[i]); }
+
+  TChA Expected;
+  {
+    ResultWriter writer(OutFNm);
+    for (int i=0; i<Vals.Len(); i++) {
+      writer.PutFlt(Vals[i]); writer.PutCh('\n');
+      Expected += TStr::Fmt("%f\n", Vals[i].Val);
+    }
+  }
+  return CompareLines("PutFlt", ReadFile(OutFNm), Expected);
+}
+
+// One step of a topic through AsyncNetworkWriter against the old inline
+// writes: "%d,%s\n" per node, a blank line and "%d,%d,%f,%f\n" per edge
+// whose alpha is above MinAlpha.
+static int TestAsyncNetworkWriter(const TStr& OutFNm) {
+  const double MinAlpha = 0.05, Time = 57.207839499999999;
+  THash<TInt, TNodeInfo> NodeNmH;
+  for (int n=0; n<100; n++) { NodeNmH.AddDat(n, TNodeInfo(TStr::Fmt("node%d", n), 0)); }
+
+  TRnd Rnd(2);
+  char Str[64];
+  EdgeIndex PotentialEdges;
+  EdgeAlphas Alphas;
+  for (int src=0; src<100; src++) {
+    for (int dst=0; dst<100; dst++) {
+      if (src == dst) { continue; }
+      snprintf(Str, sizeof(Str), "0.%06d5", Rnd.GetUniDevInt(1000000));
+      TInt edgeId = PotentialEdges.AddEdge(src, dst);
+      Alphas.Resize(PotentialEdges.Len());
+      Alphas.AddDat(edgeId, Rnd.GetUniDevInt(2) == 0 ? atof(Str) : Rnd.GetUniDev());
+    }
+  }
+
+  TemporalNetwork InferredNetwork, MaxNetwork;
+  {
+    AsyncNetworkWriter writer(InferredNetwork, MaxNetwork, NodeNmH, OutFNm, MinAlpha, 1.0, false);
+    writer.AddTopic(0, 1.0, Alphas, PotentialEdges);
+    writer.Write(Time, 0.0);
+  }
+
+  TChA Expected;
+  for (THash<TInt, TNodeInfo>::TIter NI = NodeNmH.BegI(); NI < NodeNmH.EndI(); NI++) {
+    Expected += TStr::Fmt("%d,%s\n", NI.GetKey().Val, NI.GetDat().Name.CStr());
+  }
+  Expected += "\n";
+  for (int i=0; i<Alphas.Len(); i++) {
+    const TIntPr& edge = PotentialEdges.GetEdge(Alphas.GetId(i));
+    double alpha = Alphas.GetDat(Alphas.GetId(i));
+    if (alpha <= MinAlpha) { continue; }
+    Expected += TStr::Fmt("%d,%d,%f,%f\n", edge.Val1.Val, edge.Val2.Val, Time, alpha);
+  }
+  return CompareLines("AsyncNetworkWriter", ReadFile(OutFNm + "_0.txt"), Expected);
+}
+
+// SaveCascades (and so PutCascade, which GenCascades also writes with)
+// against the old "%d;%d,%f" and ",%d,%f" writes: hits of nodes that are not
+// in NodeNmH are skipped and a cascade with no hit left writes no line.
+static int TestSaveCascades(const TStr& OutFNm) {
+  NodeInfo nodeInfo;
+  for (int n=0; n<100; n++) { nodeInfo.NodeNmH.AddDat(n, TNodeInfo(TStr::Fmt("node%d", n), 0)); }
+
+  TRnd Rnd(3);
+  char Str[64];
+  THash<TInt, TCascade> CascH;
+  for (int c=0; c<5000; c++) {
+    TCascade C(c, 0);
+    const int hitNm = Rnd.GetUniDevInt(12);
+    for (int h=0; h<hitNm; h++) {
+      snprintf(Str, sizeof(Str), "%d.%06d5", Rnd.GetUniDevInt(1000), Rnd.GetUniDevInt(1000000));
+      // nodes 100 to 119 are not in NodeNmH
+      C.Add(Rnd.GetUniDevInt(120), Rnd.GetUniDevInt(2) == 0 ? atof(Str) : Rnd.GetUniDev() * 1000);
+    }
+    CascH.AddDat(C.CId) = C;
+  }
+
+  InfoPathFileIO::SaveCascades(OutFNm, CascH, nodeInfo);
+
+  TChA Expected;
+  for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
+    Expected += TStr::Fmt("%d,%s\r\n", NI.GetKey().Val, NI.GetDat().Name.CStr());
+  }
+  Expected += "\r\n";
+  for (THash<TInt, TCascade>::TIter CI = CascH.BegI(); CI < CascH.EndI(); CI++) {
+    TCascade &C = CI.GetDat();
+    int j = 0;
+    for (THash<TInt, THitInfo>::TIter NI = C.NIdHitH.BegI(); NI < C.NIdHitH.EndI(); NI++) {
+      if (!nodeInfo.NodeNmH.IsKey(NI.GetDat().NId)) { continue; }
+      if (j > 0) { Expected += TStr::Fmt(",%d,%f", NI.GetDat().NId.Val, NI.GetDat().Tm.Val); }
+      else { Expected += TStr::Fmt("%d;%d,%f", CI.GetKey().Val, NI.GetDat().NId.Val, NI.GetDat().Tm.Val); }
+      j++;
+    }
+    if (j >= 1) { Expected += "\r\n"; }
+  }
+  return CompareLines("SaveCascades", ReadFile(OutFNm), Expected);
+}
+
+int main(int argc, char* argv[]) {
+  Env = TEnv(argc, argv, TNotify::StdNotify);
+  Env.PrepArgs(TStr::Fmt("\nCompare ResultWriter output with TStr::Fmt. build: %s, %s. Time: %s", __TIME__, __DATE__, TExeTm::GetCurTm()));
+  TExeTm ExeTm;
+  int diffNm = 0;
+  Try
+
+  const TStr OutFNm = Env.GetIfArgPrefixStr("-o:", TStr("ResultWriterTest"), "Prefix of the scratch files (default:ResultWriterTest)\n");
+
+  diffNm += TestPutFlt(OutFNm + "-flt.txt");
+  diffNm += TestAsyncNetworkWriter(OutFNm + "-network");
+  diffNm += TestSaveCascades(OutFNm + "-cascades.txt");
+
+  Catch
+  printf("\nrun time: %s (%s)\n", ExeTm.GetTmStr(), TSecTm::GetCurTm().GetTmStr().CStr());
+  return diffNm == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+#include "stdafx.h"
+#include <TimeShapingFunction.h>
+
+// Compares the scalar, virtual shaping calls with the vector versions used by
+// the cascade compiler, and the per-term log/power with the batched ones.
+
+// y[i] = base^i, as exp(i log(base)) in one omp simd loop
+void BatchPowers(const double base, double *y, const int n) {
+   const double logBase = log(base);
+   #pragma omp simd
+   for (int i=0; i<n; i++) y[i] = exp(i * logBase);
+}
+
+template <class TShaping>
+void BenchShaping(const char *name, const TShaping& shapingFunction, const double *srcTimes, const double dstTime, const int n, const int repeats) {
+   const TimeShapingFunction *virtualFunction = &shapingFunction;
+   double *dt = new double[n], *values = new double[n], *integrals = new double[n];
+   double scalarSum = 0.0, vectorSum = 0.0, maxDiff = 0.0;
+
+   TExeTm ScalarTm;
+   for (int r=0; r<repeats; r++) {
+      for (int i=0; i<n; i++) {
+         values[i] = virtualFunction->Value(srcTimes[i], dstTime);
+         integrals[i] = virtualFunction->Integral(srcTimes[i], dstTime);
+      }
+      scalarSum += values[r % n] + integrals[r % n];
+   }
+   double scalarSecs = ScalarTm.GetSecs();
+   double *scalarValues = new double[n], *scalarIntegrals = new double[n];
+   for (int i=0; i<n; i++) { scalarValues[i] = values[i]; scalarIntegrals[i] = integrals[i]; }
+
+   TExeTm VectorTm;
+   for (int r=0; r<repeats; r++) {
+      BatchTimeDiffs(srcTimes, dstTime, dt, n);
+      shapingFunction.ValueV(dt, values, n);
+      shapingFunction.IntegralV(dt, integrals, n);
+      vectorSum += values[r % n] + integrals[r % n];
+   }
+   double vectorSecs = VectorTm.GetSecs();
+
+   for (int i=0; i<n; i++) {
+      maxDiff = TMath::Mx(maxDiff, fabs(values[i] - scalarValues[i]));
+      maxDiff = TMath::Mx(maxDiff, fabs(integrals[i] - scalarIntegrals[i]));
+   }
+   printf("%s shaping: scalar %.3fs, vector %.3fs, speedup %.2fx, max diff %g (checksum %g)\n",
+          name, scalarSecs, vectorSecs, scalarSecs / TMath::Mx(vectorSecs, 1e-9), maxDiff, scalarSum - vectorSum);
+
+   delete[] dt; delete[] values; delete[] integrals;
+   delete[] scalarValues; delete[] scalarIntegrals;
+}
+
+int main(int argc, char* argv[]) {
+  Env = TEnv(argc, argv, TNotify::StdNotify);
+  Env.PrepArgs(TStr::Fmt("\nShaping function micro-benchmark. build: %s, %s. Time: %s", __TIME__, __DATE__, TExeTm::GetCurTm()));
+  TExeTm ExeTm;
+  Try
+
+  const int VectorLen = Env.GetIfArgPrefixInt("-n:", 1024, "Vector length, i.e. parents per destination (default:1024)\n");
+  const int Repeats = Env.GetIfArgPrefixInt("-r:", 100000, "Repeats (default:100000)\n");
+  const double Delta = Env.GetIfArgPrefixFlt("-d:", 1.0, "Delta for power law (default:1)\n");
+
+  TRnd Rnd(0);
+  double *srcTimes = new double[VectorLen];
+  for (int i=0; i<VectorLen; i++) srcTimes[i] = i + Rnd.GetUniDev();
+  double dstTime = VectorLen + Delta + 1.0;
+
+  EXPShapingFunction expShapingFunction;
+  POWShapingFunction powShapingFunction(Delta);
+  RAYShapingFunction rayShapingFunction;
+  BenchShaping("exponential", expShapingFunction, srcTimes, dstTime, VectorLen, Repeats);
+  BenchShaping("power law", powShapingFunction, srcTimes, dstTime, VectorLen, Repeats);
+  BenchShaping("rayleigh", rayShapingFunction, srcTimes, dstTime, VectorLen, Repeats);
+
+  // log terms of the losses
+  double *sumInLogs = new double[VectorLen];
+  for (int i=0; i<VectorLen; i++) sumInLogs[i] = 0.01 + Rnd.GetUniDev();
+  double scalarLog = 0.0, vectorLog = 0.0;
+  TExeTm ScalarLogTm;
+  for (int r=0; r<Repeats; r++) {
+     for (int i=0; i<VectorLen; i++) scalarLog += TMath::Log(sumInLogs[i]);
+  }
+  double scalarLogSecs = ScalarLogTm.GetSecs();
+  TExeTm VectorLogTm;
+  for (int r=0; r<Repeats; r++) vectorLog += BatchLogSum(sumInLogs, VectorLen);
+  double vectorLogSecs = VectorLogTm.GetSecs();
+  printf("log sum: scalar %.3fs, vector %.3fs, speedup %.2fx, relative diff %g\n",
+         scalarLogSecs, vectorLogSecs, scalarLogSecs / TMath::Mx(vectorLogSecs, 1e-9), fabs(scalarLog - vectorLog) / fabs(scalarLog));
+
+  // decay powers of FASTEN
+  const double DecayRatio = 1.01;
+  double *powers = new double[VectorLen];
+  double scalarPower = 0.0, vectorPower = 0.0, maxPowerDiff = 0.0;
+  TExeTm ScalarPowerTm;
+  for (int r=0; r<Repeats; r++) {
+     for (int i=0; i<VectorLen; i++) powers[i] = TMath::Power(DecayRatio, i);
+     scalarPower += powers[r % VectorLen];
+  }
+  double scalarPowerSecs = ScalarPowerTm.GetSecs();
+  TExeTm VectorPowerTm;
+  for (int r=0; r<Repeats; r++) {
+     BatchPowers(DecayRatio, powers, VectorLen);
+     vectorPower += powers[r % VectorLen];
+  }
+  double vectorPowerSecs = VectorPowerTm.GetSecs();
+  for (int i=0; i<VectorLen; i++) maxPowerDiff = TMath::Mx(maxPowerDiff, fabs(powers[i] - TMath::Power(DecayRatio, i)) / powers[i]);
+  printf("powers: scalar %.3fs, vector %.3fs, speedup %.2fx, max relative diff %g (checksum %g)\n",
+         scalarPowerSecs, vectorPowerSecs, scalarPowerSecs / TMath::Mx(vectorPowerSecs, 1e-9), maxPowerDiff, scalarPower - vectorPower);
+
+  delete[] srcTimes;
+  delete[] sumInLogs;
+  delete[] powers;
+
+  Catch
+  printf("\nrun time: %s (%s)\n", ExeTm.GetTmStr(), TSecTm::GetCurTm().GetTmStr().CStr());
+  return 0;
+}
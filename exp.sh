@@ -16,11 +16,13 @@ edgeNm="128"
 ./bin/generate_FASTEN_nets -g:"0.987 0.571;0.571 0.049" -ar:"0.05;""$maxAlpha" -c:1000 -f:"$cascName" -n:"$nodeNm" -e:"$edgeNm" -K:3 -m:0 
 
 InfoPathOut="result/""$expName""-InfoPath"
+InfoPathAsyncOut="result/""$expName""-InfoPathAsync"
 MixCascadesOut="result/""$expName""-MixCascades"
 MMRateOut="result/""$expName""-MMRate"
 FASTENOut="result/""$expName""-FASTEN"
 
 ./bin/InfoPath -i:"$cascName""$cascSuffix" -n:"$cascName""$netSuffix" -o:"$InfoPathOut" -rm:3 -la:"$minAlpha" -ua:"$maxAlpha" -s:0 -e:1000 -g:0.005 -bl:10 -w:5 -m:0
+./bin/InfoPath -i:"$cascName""$cascSuffix" -n:"$cascName""$netSuffix" -o:"$InfoPathAsyncOut" -rm:3 -la:"$minAlpha" -ua:"$maxAlpha" -s:0 -e:1000 -g:0.005 -bl:10 -w:5 -m:0 -as:1
 ./bin/MixCascades -i:"$cascName""$cascSuffix" -n:"$cascName""$netSuffix" -o:"$MixCascadesOut" -rm:3 -la:"$minAlpha" -ua:"$maxAlpha" -s:0 -em:10 -K:3 -e:100 -bl:10 -g:0.005 -w:5 -m:0
 ./bin/MMRate -i:"$cascName""$cascSuffix" -n:"$cascName""$netSuffix" -o:"$MMRateOut" -rm:3 -la:"$minAlpha" -ua:"$maxAlpha" -s:0 -em:10 -K:3 -e:100 -bl:10 -g:0.005 -w:5 -m:0
 ./bin/FASTEN -i:"$cascName""$cascSuffix" -n:"$cascName""$netSuffix" -o:"$FASTENOut" -rm:3 -la:"$minAlpha" -ua:"$maxAlpha" -s:0 -K:3 -em:10 -e:100 -bl:10 -g:0.005 -w:5 -m:0 
@@ -28,8 +30,8 @@ FASTENOut="result/""$expName""-FASTEN"
 txtSuffix=".txt"
 MaxTxtSuffix="_Max.txt"
 plotOut="plot/""$expName"
-modelNames="InfoPath":"MixCascades":"MMRate":"FASTEN"
-./bin/EvaluationAUC -i:"$InfoPathOut""$txtSuffix":"$MixCascadesOut""$txtSuffix":"$MMRateOut""$txtSuffix":"$FASTENOut""$txtSuffix" -n:"$cascName""$netSuffix" -o:"$plotOut" -m:"$modelNames" -ua:"$maxAlpha" 
-./bin/EvaluationMSE -i:"$InfoPathOut""$txtSuffix":"$MixCascadesOut""$MaxTxtSuffix":"$MMRateOut""$MaxTxtSuffix":"$FASTENOut""$MaxTxtSuffix" -n:"$cascName""$netSuffix" -o:"$plotOut" -m:"$modelNames" -ua:"$maxAlpha" 
+modelNames="InfoPath":"InfoPathAsync":"MixCascades":"MMRate":"FASTEN"
+./bin/EvaluationAUC -i:"$InfoPathOut""$txtSuffix":"$InfoPathAsyncOut""$txtSuffix":"$MixCascadesOut""$txtSuffix":"$MMRateOut""$txtSuffix":"$FASTENOut""$txtSuffix" -n:"$cascName""$netSuffix" -o:"$plotOut" -m:"$modelNames" -ua:"$maxAlpha" 
+./bin/EvaluationMSE -i:"$InfoPathOut""$txtSuffix":"$InfoPathAsyncOut""$txtSuffix":"$MixCascadesOut""$MaxTxtSuffix":"$MMRateOut""$MaxTxtSuffix":"$FASTENOut""$MaxTxtSuffix" -n:"$cascName""$netSuffix" -o:"$plotOut" -m:"$modelNames" -ua:"$maxAlpha" 
 ./bin/EvaluationMultiple -i:"$MixCascadesOut":"$MMRateOut":"$FASTENOut" -n:"$cascName""$netSuffix" -o:"$plotOut" -m:"MixCascades":"MMRate":"FASTEN" -ua:"$maxAlpha" 
 
@@ -37,6 +37,8 @@ int main(int argc, char* argv[]) {
   const int NCascades = Env.GetIfArgPrefixInt("-c:", 1000, "Number of cascades (default:1000)\n");
   const double Window = Env.GetIfArgPrefixFlt("-h:", 10.0, "Time horizon per cascade (default:10)\n");
   const double TotalTime = Env.GetIfArgPrefixFlt("-tt:", 100.0, "Total time (default:100)\n");
+  const bool ParallelCascades = Env.GetIfArgPrefixInt("-pg:", 0, "Generate cascades in parallel, one random stream per cascade, writing them as they are generated, 0:no, 1:yes (default:0)\n")==1;
+  const int CascadeSeed = Env.GetIfArgPrefixInt("-sd:", 0, "Seed of the per-cascade random streams (-pg:) (default:0)\n");
 
   // output filename
   const TStr FileName = Env.GetIfArgPrefixStr("-f:", TStr("example"), "Output name for network & cascades (default:example)\n");
@@ -67,7 +69,11 @@ int main(int argc, char* argv[]) {
   }
 
   // Generate Cascades
-  for (int i = 0; i < NCascades; i++) {
+  if (ParallelCascades) {
+	  fasten.GenCascades(NCascades, CascadeSeed, TStr::Fmt("%s-cascades.txt", FileName.CStr()));
+	  printf("Generate %d cascades!\n", NCascades);
+  }
+  for (int i = 0; !ParallelCascades && i < NCascades; i++) {
 	  TCascade C(fasten.CascH.Len(), fasten.nodeInfo.Model);
 	  fasten.GenCascade(C);
           fasten.CascH.AddDat(C.CId) = C;
@@ -78,12 +84,12 @@ int main(int argc, char* argv[]) {
 	  IAssert( (C.GetMaxTm() - C.GetMinTm()) <= Window );
   }
 
-  printf("Generate %d cascades!\n", fasten.GetCascs());
+  if (!ParallelCascades) printf("Generate %d cascades!\n", fasten.CascH.Len());
 
   if (TNetwork<2) fasten.SaveGroundTruth(FileName);
   InfoPathFileIO::SaveNetwork(TStr::Fmt("%s-network.txt", FileName.CStr()), fasten.Network, fasten.nodeInfo, fasten.edgeInfo);
   // Save Cascades
-  InfoPathFileIO::SaveCascades(TStr::Fmt("%s-cascades.txt", FileName.CStr()), fasten.CascH, fasten.nodeInfo);
+  if (!ParallelCascades) InfoPathFileIO::SaveCascades(TStr::Fmt("%s-cascades.txt", FileName.CStr()), fasten.CascH, fasten.nodeInfo);
   fasten.SavePriorTopicProbability(TStr::Fmt("%s_PriorTopicProbability.txt",FileName.CStr()));
 
   Catch
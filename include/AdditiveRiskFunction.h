@@ -4,12 +4,16 @@
 #include <PGD.h>
 #include <cascdynetinf.h>
 #include <TimeShapingFunction.h>
+#include <EdgeIndex.h>
+#include <CompiledCascades.h>
 
 typedef struct {
    TFlt Tol, InitAlpha, MaxAlpha, MinAlpha;
    TimeShapingFunction *shapingFunction;
    TRegularizer Regularizer;
    TFlt Mu, observedWindow;
+   bool sparseSurvival;
+   int minCoOccurrence;
 }AdditiveRiskFunctionConfigure;
 
 class AdditiveRiskFunction;
@@ -21,26 +25,44 @@ class AdditiveRiskParameter {
       AdditiveRiskParameter& operator = (const AdditiveRiskParameter&);
       AdditiveRiskParameter& operator += (const AdditiveRiskParameter&);
       AdditiveRiskParameter& operator *= (const TFlt);
-      AdditiveRiskParameter& projectedlyUpdateGradient(const AdditiveRiskParameter&);
+      AdditiveRiskParameter& projectedlyUpdateGradient(const AdditiveRiskParameter&, const Optimizer& optimizer = Optimizer());
+      TFlt projectAlpha(TFlt alpha, const TFlt alphaGradient) const;
       void reset();
       void set(AdditiveRiskFunctionConfigure configure);
 
       TFlt Tol, InitAlpha, MaxAlpha, MinAlpha;
       TRegularizer Regularizer;
       TFlt Mu;
-      THash<TIntPr,TFlt> alphas;
+      EdgeAlphas alphas;
+      EdgeMoments moments;
 };
 
 class AdditiveRiskFunction : public PGDFunction<AdditiveRiskParameter> {
    public:
       void set(AdditiveRiskFunctionConfigure configure);
-      AdditiveRiskParameter& gradient(Datum datum); 
+      void gradient(Datum datum, AdditiveRiskParameter& grad) const;
+      void prefetch(Datum datum) const { compiledCascades.Prefetch(datum); }
+      void gradient(Datum datum, const AdditiveRiskParameter& p, AdditiveRiskParameter& grad) const;
+      bool beginAsync();
+      void updateAsync(Datum datum, AdditiveRiskParameter& grad, const TFlt learningRate);
+      void endAsync();
       TFlt loss(Datum datum) const;
+      TFlt loss(Datum datum, const AdditiveRiskParameter& p) const;
       void initPotentialEdges(Data);
       
       TimeShapingFunction *shapingFunction;
       TFlt observedWindow; 
-      THash<TIntPr,TFlt> potentialEdges;
+      bool sparseSurvival;
+      int minCoOccurrence;
+      EdgeIndex potentialEdges;
+      EdgeSchedule edgeSchedule;
+      CompiledCascades compiledCascades;
+
+   private:
+      void gradientAsync(Datum datum, AdditiveRiskParameter& grad);
+
+      int asyncSetNm;
+      TIntV asyncTouched;
 };
 
 #endif 
@@ -0,0 +1,56 @@
+#ifndef ASYNCNETWORKWRITER_H
+#define ASYNCNETWORKWRITER_H
+
+#include <cascdynetinf.h>
+#include <EdgeIndex.h>
+#include <TemporalNetwork.h>
+#include <pthread.h>
+
+// Copy of the alphas of one topic at the end of a time step, with the edge
+// endpoints resolved, so that it stays valid while the next step grows the
+// potential edges and changes the parameters.
+typedef struct {
+   TInt key;
+   TFlt pi;
+   TIntPrV edges;
+   TFltV alphas;
+}TopicSnapshot;
+
+// Output stage of the per-step loop of the topic models. AddTopic snapshots
+// the topics of a step and Write hands them to a background thread, which
+// writes the OutFNm_<topic>.txt files and updates InferredNetwork (weighted
+// by pi) and MaxNetwork, while the caller starts the next step. Steps are
+// written one at a time and in order, so the results are the same as when
+// done inline. The networks must not be touched until Wait returns.
+class AsyncNetworkWriter {
+   public:
+      AsyncNetworkWriter(TemporalNetwork& inferredNetwork, TemporalNetwork& maxNetwork, const THash<TInt, TNodeInfo>& NodeNmH,
+                         const TStr& OutFNm, const double minAlpha, const double aging, const bool binaryEdges);
+      ~AsyncNetworkWriter() { Wait(); }
+
+      void AddTopic(const TInt key, const TFlt pi, const EdgeAlphas& alphas, const EdgeIndex& potentialEdges);
+      void Write(const double time, const double prevTime);
+      void Wait();
+
+   private:
+      AsyncNetworkWriter(const AsyncNetworkWriter&);
+      AsyncNetworkWriter& operator=(const AsyncNetworkWriter&);
+
+      static void* Run(void *writer);
+      void WriteStep();
+
+      TemporalNetwork& InferredNetwork;
+      TemporalNetwork& MaxNetwork;
+      const THash<TInt, TNodeInfo>& NodeNmH;
+      TStr OutFNm;
+      double MinAlpha, Aging;
+      bool BinaryEdges;
+
+      // topics of the step being written and of the step being snapshotted
+      TVec<TopicSnapshot> writing, pending;
+      double time, prevTime;
+      pthread_t thread;
+      bool isRunning;
+};
+
+#endif
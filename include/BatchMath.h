@@ -0,0 +1,40 @@
+#ifndef BATCHMATH_H
+#define BATCHMATH_H
+
+#include <cmath>
+
+// Whole-vector versions of the math in the hot loops. They are plain omp simd
+// loops: with SIMDFLAGS=-march=native (see the Makefile) the compiler emits
+// AVX2/AVX-512 code, including the vector log/exp of libmvec, and code for
+// the baseline ISA without it.
+
+inline double BatchLogSum(const double *x, const int n) {
+   double sum = 0.0;
+   #pragma omp simd reduction(+:sum)
+   for (int i=0; i<n; i++) sum += log(x[i]);
+   return sum;
+}
+
+inline void BatchLog(const double *x, double *y, const int n) {
+   #pragma omp simd
+   for (int i=0; i<n; i++) y[i] = log(x[i]);
+}
+
+// log(sum_i exp(x[i])), shifted by the maximum so that it neither overflows
+// nor underflows
+inline double BatchLogSumExp(const double *x, const int n) {
+   double mx = x[0];
+   for (int i=1; i<n; i++) if (x[i] > mx) mx = x[i];
+   double sum = 0.0;
+   #pragma omp simd reduction(+:sum)
+   for (int i=0; i<n; i++) sum += exp(x[i] - mx);
+   return mx + log(sum);
+}
+
+// dt[i] = dstTime - srcTimes[i]
+inline void BatchTimeDiffs(const double *srcTimes, const double dstTime, double *dt, const int n) {
+   #pragma omp simd
+   for (int i=0; i<n; i++) dt[i] = dstTime - srcTimes[i];
+}
+
+#endif
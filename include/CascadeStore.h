@@ -0,0 +1,85 @@
+#ifndef CASCADESTORE_H
+#define CASCADESTORE_H
+
+#include <cascdynetinf.h>
+
+// All cascades packed into flat, time-sorted arrays of hits. The hits of
+// cascade c are [GetBeg(c), GetEnd(c)). Node ids are remapped to dense
+// indices; the nodes of the NodeNmH given to AddNodes come first, in its
+// order, so that index i is the key id of the node in NodeNmH.
+//
+// SaveBin writes the store as a binary file that LoadBin maps back into
+// memory without parsing: the cascade and hit arrays of the store point into
+// the mapping, so loading only builds the node table. No cascades can be
+// added to a loaded store until Clr.
+class CascadeStore {
+   public:
+      CascadeStore() : mapped(NULL), mappedLen(0) {}
+      ~CascadeStore() { Clr(); }
+
+      void AddNodes(const THash<TInt, TNodeInfo>& NodeNmH);
+      int AddNode(const TInt NId);
+      void AddCascade(const TInt CId, TFltIntPrV& TmNIdV);
+      void AddCascade(const TCascade& Cascade);
+      void Pack(const THash<TInt, TCascade>& CascH, const THash<TInt, TNodeInfo>& NodeNmH);
+      void SaveBin(const TStr& OutFNm, const THash<TInt, TNodeInfo>& NodeNmH) const;
+      void LoadBin(const TStr& InFNm, THash<TInt, TNodeInfo>& NodeNmH);
+      void Clr();
+
+      bool Empty() const { return cascadeIds.Empty(); }
+      bool IsMapped() const { return mapped != NULL; }
+
+      int Len() const { return cascadeIds.Len(); }
+      TInt GetCId(const int c) const { return cascadeIds[c]; }
+      int GetBeg(const int c) const { return offsets[c]; }
+      int GetEnd(const int c) const { return offsets[c+1]; }
+      int GetCascadeLen(const int c) const { return offsets[c+1] - offsets[c]; }
+      int GetLenBeforeT(const int c, const double time) const;
+      double GetMinTm(const int c) const { return hitTimes[offsets[c]]; }
+      double GetMaxTm(const int c) const { return hitTimes[offsets[c+1]-1]; }
+      // starts loading the first hits of cascade c into the cache
+      void Prefetch(const int c) const;
+
+      int GetHitNm() const { return hitNodes.Len(); }
+      int GetNode(const int hit) const { return hitNodes[hit]; }
+      TInt GetNId(const int hit) const { return nodeIds[hitNodes[hit]]; }
+      double GetTm(const int hit) const { return hitTimes[hit]; }
+
+      int GetNodes() const { return nodeIds.Len(); }
+      TInt GetNodeNId(const int node) const { return nodeIds[node]; }
+      int GetNodeIdx(const TInt NId) const;
+
+   private:
+      CascadeStore(const CascadeStore&);
+      CascadeStore& operator=(const CascadeStore&);
+
+      TIntV cascadeIds;
+      TIntV offsets;
+      TIntV hitNodes;
+      TFltV hitTimes;
+      TIntV nodeIds;
+      THash<TInt, TInt> nodeIdxH;
+      void *mapped;
+      size_t mappedLen;
+};
+
+// Infection times of one cascade at a time in a dense array indexed by node,
+// so membership and time lookups need no hashing. Load and Unload cost the
+// length of the cascade; keep one per thread.
+class CascadeTimes {
+   public:
+      CascadeTimes(const CascadeStore& cascadeStore);
+      void Load(const int c);
+      void Unload();
+
+      bool IsNode(const int node) const { return times[node] != NotInfected; }
+      double GetTm(const int node) const { return times[node]; }
+
+   private:
+      static const double NotInfected;
+      const CascadeStore& store;
+      TFltV times;
+      int cascade;
+};
+
+#endif
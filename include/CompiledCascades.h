@@ -0,0 +1,75 @@
+#ifndef COMPILEDCASCADES_H
+#define COMPILEDCASCADES_H
+
+#include <Parameter.h>
+#include <TimeShapingFunction.h>
+#include <EdgeIndex.h>
+
+// A candidate parent of a destination node: the potential edge it would use
+// (-1 when the pair is not a potential edge), its position in the cascade and
+// the shaping values evaluated at the destination time.
+typedef struct {
+   int edgeId, position;
+   double value, integral;
+}ParentEntry;
+
+// Parameter independent part of one cascade at one time step. Only the
+// destinations with at least one parent entry are stored. Infected
+// destinations keep every earlier hit as a parent, uninfected ones only the
+// potential edges, since nothing else contributes to their survival term.
+//
+// The dense compile visits every node in NodeNmH and keeps that order. The
+// sparse one visits the infected nodes and then the outgoing potential edges
+// of each source, so its cost is cascade size x out-degree instead of
+// network size x cascade size; destinations come out in discovery order.
+//
+// Both are templates on the concrete shaping function, so the shaping calls
+// are bound statically, and the values of all parents of a destination are
+// evaluated with one vector call.
+class CompiledCascade {
+   public:
+      template <class TShaping>
+      void Compile(const CascadeStore& store, const int c, const CascadeTimes& times, const int nodeNm, const EdgeIndex& potentialEdges,
+                   const TShaping& shapingFunction, const double CurrentTime, const double observedWindow);
+      template <class TShaping>
+      void CompileSparse(const CascadeStore& store, const int c, const CascadeTimes& times, const int nodeNm, const EdgeIndex& potentialEdges,
+                         const TIntV& edgeDstNodes, const TShaping& shapingFunction, const double CurrentTime, const double observedWindow);
+      void Clr();
+      // starts loading the head of the arrays a sweep reads into the cache
+      void Prefetch() const;
+
+      int Len() const { return dstNIds.Len(); }
+      TInt GetDstNId(const int i) const { return dstNIds[i]; }
+      bool IsInfected(const int i) const { return infected[i]; }
+      int GetBeg(const int i) const { return offsets[i]; }
+      int GetEnd(const int i) const { return offsets[i+1]; }
+      int GetParentNm() const { return parents.Len(); }
+      const ParentEntry& GetParent(const int j) const { return parents[j]; }
+
+   private:
+      void AddDst(const TInt dstNId, const bool isInfected);
+
+      TIntV dstNIds;
+      TBoolV infected;
+      TIntV offsets;
+      TVec<ParentEntry> parents;
+};
+
+// Compiled cascades indexed by the position of the cascade in the store of
+// the data. Compile picks the kernels for the shaping model once per call.
+class CompiledCascades {
+   public:
+      void Compile(Data data, const EdgeIndex& potentialEdges, const TimeShapingFunction *shapingFunction, const double observedWindow, const bool sparseSurvival = false);
+      const CompiledCascade& GetCascade(const Datum& datum) const { return cascades[datum.position]; }
+      void Prefetch(const Datum& datum) const { if (datum.position < cascades.Len()) cascades[datum.position].Prefetch(); }
+      int Len() const { return cascades.Len(); }
+      void Clr() { cascades.Clr(); }
+
+   private:
+      template <class TShaping>
+      void CompileModel(Data data, const EdgeIndex& potentialEdges, const TShaping& shapingFunction, const double observedWindow, const bool sparseSurvival);
+
+      TVec<CompiledCascade> cascades;
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <Parameter.h>
 #include <PGD.h>
+#include <BatchMath.h>
 #include <cascdynetinf.h>
 
 template <typename parameter>
@@ -20,20 +21,19 @@ class EM {
    public:
       void Optimize(EMLikelihoodFunction<parameter> &LF, Data data) {
          EMIterNm = 0;
+         // a step with no eligible cascades leaves the parameters as they are
+         if (data.cascadesPositions.Empty()) return;
          TFlt::Rnd.PutSeed(0);
          TInt::Rnd.PutSeed(0);
          TFlt maxLoss = DBL_MAX;
          parameter bestParameter;
          truthLoss = -DBL_MAX;
+         LF.BumpParameterVersion();
          while(!IsTerminate()) {
 
-            sampledCascadesPositions.Clr();
-            sampledCascadesPositions.Reserve(configure.pGDConfigure.maxIterNm * configure.pGDConfigure.batchSize);
-            for (size_t j=0;j<configure.pGDConfigure.maxIterNm;j++) {
-               for (size_t i=0;i<configure.pGDConfigure.batchSize;i++) {
-                  int index = InfoPathSampler::sample(configure.pGDConfigure.sampling, configure.pGDConfigure.ParamSampling, data.cascadesPositions.Len());
-                  sampledCascadesPositions.Add(data.cascadesPositions.GetKey(index));
-               }
+            sampler.sample(data.cascadesPositions.Len(), configure.pGDConfigure.maxIterNm * configure.pGDConfigure.batchSize, sampledCascadesPositions);
+            for (int i=0;i<sampledCascadesPositions.Len();i++) {
+               sampledCascadesPositions[i] = data.cascadesPositions.GetKey(sampledCascadesPositions[i]);
             }
             Expectation(LF,data);      
             Maximization(LF,data);
@@ -51,40 +51,52 @@ class EM {
       }
       void set(EMConfigure configure) {
          this->configure = configure;;
+         sampler.set(configure.pGDConfigure.sampling, configure.pGDConfigure.ParamSampling);
+         sampler.setEpochs(configure.pGDConfigure.epochs);
+         optimizer.set(configure.pGDConfigure.optimizer, configure.pGDConfigure.learningRate);
       }
 
    private:
       EMConfigure configure;
+      InfoPathSampler sampler;
+      Optimizer optimizer;
       size_t iterNm, EMIterNm;
       TFlt loss, truthLoss;
       TIntV sampledCascadesPositions;
 
+      // The sampled positions repeat, and the parameters do not change during
+      // the E-step, so every distinct cascade is evaluated once, all topics in
+      // one call. Each call then runs its own loop on a single thread. Most of
+      // them are cache hits from the truthLoss that ended the last M-step.
       void Expectation(EMLikelihoodFunction<parameter> &LF, Data data) const {
-         for (TIntV::TIter CI = sampledCascadesPositions.BegI(); CI < sampledCascadesPositions.EndI(); CI++) {
-            TInt key = data.cascH.GetKey(*CI);
-            Datum datum = {data.NodeNmH, data.cascH, key, data.time};
-
-            TInt size = configure.latentVariableSize;
-            THash<TInt,TFlt> jointLikelihoodTable;
-            for (TInt latentVariable=0; latentVariable < size; latentVariable++) {
-               jointLikelihoodTable.AddDat(latentVariable, LF.JointLikelihood(datum,latentVariable));
-            }
+         TIntV positions(sampledCascadesPositions);
+         positions.Sort();
+         positions.Merge();
+
+         int size = configure.latentVariableSize;
+         int cascadesNum = positions.Len();
+
+         #pragma omp parallel
+         {
+            double *jointLikelihoodTable = new double[size];
 
-            THash<TInt,TFlt> &latentDistribution = LF.latentDistributions.GetDat(key);
-            for (TInt latentVariable=0; latentVariable < size; latentVariable++) {
-               TFlt likelihood = 0.0;
-               for (TInt i=0; i < size; i++)
-                  likelihood += TMath::Power(TMath::E, jointLikelihoodTable.GetDat(i) - jointLikelihoodTable.GetDat(latentVariable));
-               latentDistribution.GetDat(latentVariable) = 1.0/likelihood;
-               //printf("index:%d, k:%d, p:%f, likelihood:%f\n",CI.GetKey()(),latentVariable(),latentDistribution.GetDat(latentVariable)(),likelihood());
+            #pragma omp for schedule(dynamic)
+            for (int c=0; c<cascadesNum; c++) {
+               Datum datum = {data.NodeNmH, data.cascades, data.cascades.GetCId(positions[c]), positions[c], data.time};
+               LF.CachedJointLikelihoods(datum, jointLikelihoodTable);
+
+               double logLikelihood = BatchLogSumExp(jointLikelihoodTable, size);
+               TFlt *latentDistribution = &LF.latentDistributions[positions[c] * size];
+               for (int latentVariable=0; latentVariable < size; latentVariable++)
+                  latentDistribution[latentVariable] = exp(jointLikelihoodTable[latentVariable] - logLikelihood);
             }
+
+            delete[] jointLikelihoodTable;
          }
       }
       void Maximization(EMLikelihoodFunction<parameter> &LF, Data data) {
          iterNm = 0;
       
-         double time = data.time;
-         THash<TInt, TCascade> &cascH = data.cascH;
          size_t sampledIndex = 0;
          TIntFltH sampledCascadesPositionsHash;
       
@@ -93,34 +105,42 @@ class EM {
             int position = sampledCascadesPositions[i];
             sampledCascadesPositionsHash.AddDat(position, 0.0);
          }
-         Data sampleData = {data.NodeNmH, data.cascH, sampledCascadesPositionsHash, data.time};
+         Data sampleData = {data.NodeNmH, data.cascades, sampledCascadesPositionsHash, data.time};
          loss = LF.PGDFunction<parameter>::loss(sampleData)/(double)size;
          printf("iterNm: %d, loss: %f ",(int)iterNm,loss());
          if (truthLoss == -DBL_MAX) 
-            truthLoss = LF.truthLoss(sampleData)/(double)data.cascH.Len();
+            truthLoss = LF.truthLoss(sampleData)/(double)data.cascades.Len();
          printf(", truth loss: %f -> ",truthLoss());
          fflush(stdout);
          sampledCascadesPositionsHash.Clr();
 
          while(iterNm < configure.pGDConfigure.maxIterNm) { 
             parameter parameterDiff;
+            TIntV batch;
             for (size_t i=0;i<configure.pGDConfigure.batchSize;i++, sampledIndex++) {
                int position = sampledCascadesPositions[sampledIndex];
                sampledCascadesPositionsHash.AddDat(position, 0.0);
-               Datum datum = {data.NodeNmH, cascH, cascH.GetKey(position), time};
-               parameterDiff += LF.gradient(datum);
+               batch.Add(position);
             }
+            TIntV nextBatch;
+            for (size_t i=0;i<configure.pGDConfigure.batchSize && sampledIndex+i<size;i++) nextBatch.Add(sampledCascadesPositions[sampledIndex+i]);
+            LF.batchGradient(data, batch, parameterDiff, nextBatch);
             parameterDiff *= (configure.pGDConfigure.learningRate/double(configure.pGDConfigure.batchSize));
-            LF.parameter.projectedlyUpdateGradient(parameterDiff);
+            optimizer.NextStep();
+            LF.parameter.projectedlyUpdateGradient(parameterDiff, optimizer);
+            LF.BumpParameterVersion();
             iterNm++;
          }
          LF.maximize(); 
+         LF.BumpParameterVersion();
                
          loss = LF.PGDFunction<parameter>::loss(sampleData)/(double)size;
          printf("iterNm: %d, loss: %f",(int)iterNm,loss());
-         truthLoss = LF.truthLoss(sampleData)/(double)data.cascH.Len();
+         truthLoss = LF.truthLoss(sampleData)/(double)data.cascades.Len();
          printf(", truth loss: %f\033[0K\r",truthLoss());
          printf("\n");
+         printf("likelihood cache hit rate: %f\n",LF.GetCacheHitRate());
+         LF.ResetCacheStatistics();
          fflush(stdout);
       }
 };
@@ -130,37 +150,81 @@ class EMLikelihoodFunction : public PGDFunction<parameter> {
    friend class EM<parameter>;
    public:
       virtual TFlt JointLikelihood(Datum datum, TInt latentVariable) const = 0;
+      // Fills the log joint likelihood of every topic. Functions that can
+      // evaluate all topics in one sweep over the cascade override it.
+      virtual void JointLikelihoodAllTopics(Datum datum, double *jointLikelihoods) const {
+         for (TInt i=0;i<latentVariableSize;i++) jointLikelihoods[i] = JointLikelihood(datum,i);
+      }
       virtual void maximize() = 0;
       TFlt loss(Datum datum) const {
+         double *jointLikelihoods = new double[latentVariableSize];
+         CachedJointLikelihoods(datum, jointLikelihoods);
          TFlt datumLoss = 0.0;
-         for (TInt i=0;i<latentVariableSize;i++) datumLoss += latentDistributions.GetDat(datum.index).GetDat(i) * JointLikelihood(datum,i);
+         for (TInt i=0;i<latentVariableSize;i++) datumLoss += GetLatentProbability(datum,i) * jointLikelihoods[i];
+         delete[] jointLikelihoods;
          return -1.0 * datumLoss;
       }
       TFlt truthLoss(Data data) const {
-         TFlt totalLoss = 0.0;
-         for (THash<TInt, TCascade>::TIter CI = data.cascH.BegI(); !CI.IsEnd(); CI++) {
-            TInt index = CI.GetKey();
-            Datum datum = {data.NodeNmH, data.cascH, index, data.time};
-            TFlt datumLoss = 0.0;
-            for (TInt i=0;i<latentVariableSize;i++) 
-               datumLoss += TMath::Power(TMath::E, JointLikelihood(datum,i));
-            if (datumLoss < DBL_MIN) datumLoss = DBL_MIN;
-            totalLoss += TMath::Log(datumLoss);
+         double totalLoss = 0.0;
+         #pragma omp parallel for schedule(dynamic) reduction(+:totalLoss)
+         for (int c=0; c<data.cascades.Len(); c++) {
+            Datum datum = {data.NodeNmH, data.cascades, data.cascades.GetCId(c), c, data.time};
+            double *jointLikelihoods = new double[latentVariableSize];
+            CachedJointLikelihoods(datum, jointLikelihoods);
+            double datumLoss = BatchLogSumExp(jointLikelihoods, latentVariableSize);
+            if (datumLoss < log(DBL_MIN)) datumLoss = log(DBL_MIN);
+            totalLoss += datumLoss;
+            delete[] jointLikelihoods;
          } 
          return -1.0 * totalLoss;
       }
       void InitLatentVariable(Data data, EMConfigure configure) {
-         latentDistributions.Clr();
          latentVariableSize = configure.latentVariableSize;
-         for (THash<TInt, TCascade>::TIter CI = data.cascH.BegI(); !CI.IsEnd(); CI++) {
-            THash<TInt,TFlt> latentDistribution;
-            for (TInt i=0;i<latentVariableSize;i++) latentDistribution.AddDat(i,double(1/latentVariableSize));
-            latentDistributions.AddDat(CI.GetKey(),latentDistribution);
+         latentDistributions.Gen(data.cascades.Len() * latentVariableSize);
+         latentDistributions.PutAll(double(1/latentVariableSize));
+
+         likelihoodCache.Gen(data.cascades.Len() * latentVariableSize);
+         cacheVersions.Gen(data.cascades.Len());
+         cacheVersions.PutAll(-1);
+         parameterVersion = 0;
+         ResetCacheStatistics();
+      }
+      TFlt GetLatentProbability(const Datum& datum, const int latentVariable) const {
+         return latentDistributions[datum.position * latentVariableSize + latentVariable];
+      }
+
+      // JointLikelihoodAllTopics memoized per cascade. An entry is valid while
+      // the parameter version it was computed at is current; the optimizer
+      // bumps the version whenever it changes the parameters or the compiled
+      // cascades. A cascade must not be evaluated by two threads at once.
+      void CachedJointLikelihoods(const Datum& datum, double *jointLikelihoods) const {
+         int c = datum.position;
+         TFlt *cached = &likelihoodCache[c * latentVariableSize];
+         if (cacheVersions[c] == parameterVersion) {
+            for (int i=0;i<latentVariableSize;i++) jointLikelihoods[i] = cached[i];
+            #pragma omp atomic
+            cacheHits++;
+            return;
          }
+         JointLikelihoodAllTopics(datum, jointLikelihoods);
+         for (int i=0;i<latentVariableSize;i++) cached[i] = jointLikelihoods[i];
+         cacheVersions[c] = parameterVersion;
+         #pragma omp atomic
+         cacheMisses++;
       }
+      void BumpParameterVersion() { parameterVersion++; }
+      double GetCacheHitRate() const { return cacheHits + cacheMisses == 0 ? 0.0 : double(cacheHits) / double(cacheHits + cacheMisses); }
+      void ResetCacheStatistics() { cacheHits = cacheMisses = 0; }
    public:
       TInt latentVariableSize;
-      THash<TInt, THash<TInt,TFlt> > latentDistributions;
+      // latentDistributions[c * latentVariableSize + k] is the probability of
+      // topic k for the cascade at position c in the store.
+      TFltV latentDistributions;
+   private:
+      mutable TFltV likelihoodCache;
+      mutable TIntV cacheVersions;
+      int parameterVersion;
+      mutable long long cacheHits, cacheMisses;
 };
 
 #endif
@@ -0,0 +1,73 @@
+#ifndef EDGEINDEX_H
+#define EDGEINDEX_H
+
+#include <cascdynetinf.h>
+#include <CascadeStore.h>
+
+// Assigns every discovered (src,dst) pair a dense integer id so that
+// per-edge values can live in flat arrays instead of THash<TIntPr,TFlt>.
+class EdgeIndex {
+   public:
+      TInt AddEdge(const TInt srcNId, const TInt dstNId);
+      TInt GetEdgeId(const TInt srcNId, const TInt dstNId) const;
+      bool IsEdge(const TInt srcNId, const TInt dstNId) const { return edgeIds.IsKey(TIntPr(srcNId, dstNId)); }
+      const TIntPr& GetEdge(const TInt edgeId) const { return edges[edgeId]; }
+      int GetOutDeg(const TInt srcNId) const { return outEdgeIds.IsKey(srcNId) ? outEdgeIds.GetDat(srcNId).Len() : 0; }
+      const TIntV& GetOutEdgeIds(const TInt srcNId) const { return outEdgeIds.GetDat(srcNId); }
+      int Len() const { return edges.Len(); }
+      void Clr();
+
+   private:
+      THash<TIntPr,TInt> edgeIds;
+      TIntPrV edges;
+      THash<TInt,TIntV> outEdgeIds;
+};
+
+// Every (src,dst) pair in which src precedes dst in at least minCoOccurrence
+// cascades, with the earliest dst infection time over those cascades, sorted
+// by that time. The pairs are walked once in Build; Activate then adds to an
+// EdgeIndex only the pairs that became eligible since the previous call,
+// since the candidate set only grows with time.
+class EdgeSchedule {
+   public:
+      EdgeSchedule() : built(false), next(0) {}
+      void Build(const CascadeStore& cascades, const int minCoOccurrence = 1);
+      int Activate(const double time, EdgeIndex& potentialEdges);
+      bool IsBuilt() const { return built; }
+      int Len() const { return pairs.Len(); }
+      void Clr();
+
+   private:
+      static const int64 PairBudget = 1 << 25;
+
+      bool built;
+      int next;
+      TIntPrV pairs;
+      TFltIntPrV activations;
+};
+
+// Per-edge values keyed by edge id. Only the ids that have been assigned a
+// value are visited by the sweeps, in the order they were first assigned.
+class EdgeAlphas {
+   public:
+      EdgeAlphas& operator += (const EdgeAlphas&);
+      EdgeAlphas& operator *= (const TFlt);
+
+      int Len() const { return ids.Len(); }
+      TInt GetId(const int i) const { return ids[i]; }
+      bool IsKey(const TInt edgeId) const { return edgeId >= 0 && edgeId < isSet.Len() && isSet[edgeId]; }
+      TFlt GetDat(const TInt edgeId) const { return values[edgeId]; }
+      TFlt& GetDat(const TInt edgeId) { return values[edgeId]; }
+      TFlt GetDat(const TInt edgeId, const TFlt defaultValue) const { return IsKey(edgeId) ? values[edgeId] : defaultValue; }
+      TFlt& AddDat(const TInt edgeId, const TFlt value);
+      void Resize(const int edgeNm);
+      void Fill(const int edgeNm, const TFlt value);
+      void Clr();
+
+   private:
+      TFltV values;
+      TBoolV isSet;
+      TIntV ids;
+};
+
+#endif
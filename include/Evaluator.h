@@ -2,6 +2,7 @@
 #define EVALUATOR_H
 
 #include <cascdynetinf.h>
+#include <TemporalNetwork.h>
 
 typedef TFltPr PRCPoint;
 typedef TVec<PRCPoint> PRCPoints;
@@ -18,13 +19,13 @@ class Evaluator {
     void PlotPRC(const TStr &Str) const;
     void PlotMSE(const TStr &Str) const;
 
-    TVec<TFlt> GetSteps(size_t i) const;
+    const TFltV& GetSteps(size_t i) const;
     TFlt GetGroundTruthTimeStep(TFlt step) const;
     TFlt GetInferredTimeStep(TFlt step, size_t i) const;
 
   public:
     TStrFltFltHNEDNet GroundTruth;  
-    TVec<TStrFltFltHNEDNet> InferredNetworks;
+    TVec<TemporalNetwork> InferredNetworks;
     TVec<TStr> ModelNames;
     TVec<DyPRCPoints> PRC; 
     TVec<TFltFltH> MSE, MAE, PRC_AUC;
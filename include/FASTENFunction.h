@@ -3,6 +3,8 @@
 
 #include <EM.h>
 #include <TimeShapingFunction.h>
+#include <EdgeIndex.h>
+#include <CompiledCascades.h>
 
 typedef struct {
    TFlt Tol, InitAlpha, MaxAlpha, MinAlpha;
@@ -21,21 +23,22 @@ class FASTENParameter {
       FASTENParameter& operator = (const FASTENParameter&);
       FASTENParameter& operator += (const FASTENParameter&);
       FASTENParameter& operator *= (const TFlt);
-      FASTENParameter& projectedlyUpdateGradient(const FASTENParameter&);
+      FASTENParameter& projectedlyUpdateGradient(const FASTENParameter&, const Optimizer& optimizer = Optimizer());
       void set(FASTENFunctionConfigure configure);
       void init(Data data, TInt NodeNm = 0);
       void initPriorTopicProbabilityParameter();
       void initAlphaParameter();
       void reset();
 
-      TFlt GetTopicAlpha(TInt srcNId, TInt dstNId, TInt topic) const;
-      TFlt GetAlpha(TInt srcNId, TInt dstNId, TInt NId) const;
+      TFlt GetTopicAlpha(TInt edgeId, TInt topic) const;
+      TFlt GetAlpha(TInt edgeId, TInt topic) const;
 
       TFlt Tol, InitAlpha, MaxAlpha, MinAlpha;
       TRegularizer Regularizer;
       TFlt Mu;
       TInt latentVariableSize;   
-      THash<TInt, THash<TIntPr,TFlt> > kAlphas;
+      THash<TInt, EdgeAlphas> kAlphas;
+      THash<TInt, EdgeMoments> kMoments;
       THash<TInt, TFlt> priorTopicProbability;
       TFlt sampledTimes;
 };
@@ -43,20 +46,28 @@ class FASTENParameter {
 class FASTENFunction : public EMLikelihoodFunction<FASTENParameter> {
    public:
       TFlt JointLikelihood(Datum datum, TInt latentVariable) const;
+      void JointLikelihoodAllTopics(Datum datum, double *jointLikelihoods) const;
       void maximize() ;
-      FASTENParameter& gradient(Datum datum);
+      void gradient(Datum datum, FASTENParameter& grad) const;
+      void prefetch(Datum datum) const { compiledCascades.Prefetch(datum); }
+      void accumulateStatistics(Datum datum);
       void set(FASTENFunctionConfigure configure);
       void init(Data data, TInt NodeNm = 0);
       void initPriorTopicProbabilityParameter() { parameter.initPriorTopicProbabilityParameter();}
       void initAlphaParameter() { parameter.initAlphaParameter();}
       void initPotentialEdges(Data);
-      TFlt GetTopicAlpha(TInt srcNId, TInt dstNId, TInt topic) const { return parameter.GetTopicAlpha(srcNId, dstNId, topic);}
-      TFlt GetAlpha(TInt srcNId, TInt dstNId, TInt topic) const { return parameter.GetAlpha(srcNId, dstNId, topic);}
+      TFlt GetTopicAlpha(TInt srcNId, TInt dstNId, TInt topic) const { return parameter.GetTopicAlpha(potentialEdges.GetEdgeId(srcNId, dstNId), topic);}
+      TFlt GetAlpha(TInt srcNId, TInt dstNId, TInt topic) const { return parameter.GetAlpha(potentialEdges.GetEdgeId(srcNId, dstNId), topic);}
 
       TimeShapingFunction *shapingFunction; 
-      THash<TIntPr,TFlt> potentialEdges;
+      EdgeIndex potentialEdges;
+      EdgeSchedule edgeSchedule;
+      CompiledCascades compiledCascades;
       TFlt observedWindow;
+      bool sparseSurvival;
+      int minCoOccurrence;
       TFlt decayRatio;
+      TFltV decayPowers;
 };
 
 #endif
@@ -12,11 +12,14 @@ class FASTENModel {
       NodeInfo nodeInfo;
       EdgeInfo edgeInfo;
       THash<TInt, TCascade> CascH;
-      TStrFltFltHNEDNet Network, InferredNetwork, MaxNetwork; 
+      CascadeStore CascStore;
+      TStrFltFltHNEDNet Network;
+      TemporalNetwork InferredNetwork, MaxNetwork;
       THash<TInt, THash<TIntPr,TFlt> > usedEdges;
       THash<TInt, THash<TInt,TInt> > outputEdgeMap;
      
       TFlt Window, TotalTime; 
+      TBool BinaryEdges;
       TFlt Delta, K;
       TFlt Gamma, Aging;
 
@@ -27,6 +30,7 @@ class FASTENModel {
       EM<FASTENParameter> em;
 
       void LoadCascadesTxt(const TStr& InFNm);
+      void LoadCascadesBin(const TStr& InFNm);
       void LoadGroundTruthTxt(const TStr& InFNm);
       void SaveInferred(const TStr& OutFNm);
       void SavePriorTopicProbability(const TStr& OutFNm);
@@ -34,6 +38,9 @@ class FASTENModel {
       void ReadAlphas(const TStr& OutFNm);
 
       void GenCascade(TCascade& c);
+      void GenCascade(TCascade& c, TRnd& FltRnd, TRnd& IntRnd, TInt& topic, TIntPrV& UsedEdgeV);
+      void GenCascades(const int CascadeNm, const int Seed, const TStr& OutFNm);
+      void AddUsedEdges(const TInt topic, const TIntPrV& UsedEdgeV);
       void GenerateGroundTruth(const int& TNetwork, const int& NNodes, const int& NEdges, const TStr& NetworkParams);
       void SaveGroundTruth(TStr);
 
@@ -41,7 +48,10 @@ class FASTENModel {
       void SetTotalTime(const float& tt) { TotalTime = tt; }
       void SetModel(const TModel& model) { nodeInfo.Model = model; }
       void SetWindow(const double& window) { Window = window; }
+      void SetBinaryEdges(const bool binaryEdges) { BinaryEdges = binaryEdges; }
       void SetObservedWindow(const double& window) { lossFunction.observedWindow = window; }
+      void SetSparseSurvival(const bool sparse) { lossFunction.sparseSurvival = sparse; }
+      void SetMinCoOccurrence(const int minCoOccurrence) { lossFunction.minCoOccurrence = minCoOccurrence; }
       void SetDelta(const double& delta) { Delta = delta; }
       void SetK(const double& k) { K = k; }
 
@@ -49,6 +59,8 @@ class FASTENModel {
       void SetBatchSize(const size_t batchSize) { eMConfigure.pGDConfigure.batchSize = batchSize;}
       void SetSampling(const TSampling sampling) { eMConfigure.pGDConfigure.sampling = sampling;} 
       void SetParamSampling(const TStr paramSampling) { eMConfigure.pGDConfigure.ParamSampling = paramSampling;}
+      void SetEpochs(const bool epochs) { eMConfigure.pGDConfigure.epochs = epochs;}
+      void SetOptimizer(const TOptimizer optimizer) { eMConfigure.pGDConfigure.optimizer = optimizer;}
       void SetMaxIterNm(const size_t maxIterNm) { eMConfigure.pGDConfigure.maxIterNm = maxIterNm;}
       void SetMaxEMIterNm(const size_t maxIterNm) { eMConfigure.maxIterNm = maxIterNm;}
 
@@ -62,7 +74,7 @@ class FASTENModel {
       void SetInitAlpha(const double& ia) { fastenFunctionConfigure.InitAlpha = ia; }
 
       void Init();
-      int GetCascs() { return CascH.Len(); }
+      int GetCascs() { return CascStore.Len(); }
       void Infer(const TFltV&, const TStr& OutFNm);
 };
 
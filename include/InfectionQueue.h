@@ -0,0 +1,31 @@
+#ifndef INFECTIONQUEUE_H
+#define INFECTIONQUEUE_H
+
+#include <cascdynetinf.h>
+
+// Binary min-heap of the nodes of a simulated cascade that are waiting to run
+// their infection, keyed by infection time, with decrease-key. Replaces
+// sorting the whole infected node hash at every step of the simulation.
+class InfectionQueue {
+   public:
+      void Push(const TInt NId, const double time);
+      // lowers the time of a node still in the queue
+      void DecreaseKey(const TInt NId, const double time);
+      bool IsKey(const TInt NId) const { return positionH.IsKey(NId); }
+      bool Empty() const { return nodes.Empty(); }
+      TInt GetMinNId() const { return nodes[0]; }
+      double GetMinTm() const { return times[0]; }
+      void PopMin();
+      void Clr();
+
+   private:
+      void Place(const int position, const TInt NId, const double time);
+      void SiftUp(int position);
+      void SiftDown(int position);
+
+      TIntV nodes;
+      TFltV times;
+      THash<TInt, TInt> positionH;
+};
+
+#endif
@@ -2,6 +2,8 @@
 #define INFOPATHFILEIO_H
 
 #include <cascdynetinf.h>
+#include <CascadeStore.h>
+#include <TemporalNetwork.h>
 
 struct NodeInfo {
    THash<TInt, TNodeInfo> NodeNmH;
@@ -16,17 +18,29 @@ struct EdgeInfo {
 class InfoPathFileIO {
    public:
       static void LoadCascadesTxt(TSIn& SIn, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, bool verbose=false);
+      static void LoadCascadesTxt(TSIn& SIn, CascadeStore& cascades, NodeInfo &nodeInfo, bool verbose=false);
+      // The file name variants map the file and parse its lines on all threads.
+      static void LoadCascadesTxt(const TStr& InFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, bool verbose=false);
+      static void LoadNetworkTxt(const TStr& InFNm, TStrFltFltHNEDNet& Network, NodeInfo &nodeInfo, bool verbose=false);
+      static void AddCascadesTxt(const TStr& InFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, bool verbose=false);
+      static void LoadCascadesBin(const TStr& InFNm, CascadeStore& cascades, NodeInfo &nodeInfo, bool verbose=false);
       static void LoadNetworkTxt(TSIn& SIn, TStrFltFltHNEDNet& Network, NodeInfo &nodeInfo, bool verbose=false);
 
       static void AddCascadesTxt(TSIn& SIn, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, bool verbose=false);
+      static void AddCascadesTxt(TSIn& SIn, CascadeStore& cascades, NodeInfo &nodeInfo, bool verbose=false);
       static void AddNetworkTxt(TSIn& SIn, TStrFltFltHNEDNet& Network, NodeInfo &nodeInfo, bool verbose=false);
 
       static void SaveNetwork(const TStr& OutFNm, TStrFltFltHNEDNet& Network, NodeInfo &nodeInfo, EdgeInfo &edgeInfo, const TIntV& NIdV=TIntV());
+      static void SaveNetwork(const TStr& OutFNm, const TemporalNetwork& Network, NodeInfo &nodeInfo, EdgeInfo &edgeInfo);
       static void SaveCascades(const TStr& OutFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo); 
+      static void SaveCascadesBin(const TStr& OutFNm, const CascadeStore& cascades, NodeInfo &nodeInfo);
 
       static void GenerateInferredNetwork(TStrFltFltHNEDNet& Network, THash<TInt,TStrFltFltHNEDNet>& MultipleNetworks);
    private:
       static void AddCasc(const TStr& CascStr, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, int CId=-1);
+      static void AddCasc(const TStr& CascStr, CascadeStore& cascades, NodeInfo &nodeInfo, int CId=-1);
+      static void ParseCascadesTxt(const TStr& InFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, const bool renumber, bool verbose);
+      static bool ParseCasc(const char *beg, const char *end, const THash<TInt, TNodeInfo>& NodeNmH, TIntV& vols, TCascade& C);
       static void AddNodeNm(const int& NId, const TNodeInfo& Info, NodeInfo &nodeInfo);
       static void AddDomainNm(const TStr& Domain, NodeInfo &nodeInfo, const int& DomainId=-1);
 
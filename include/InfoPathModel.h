@@ -12,7 +12,9 @@ class InfoPathModel {
       NodeInfo nodeInfo;
       EdgeInfo edgeInfo;
       THash<TInt, TCascade> CascH;
-      TStrFltFltHNEDNet Network, InferredNetwork;
+      CascadeStore CascStore;
+      TStrFltFltHNEDNet Network;
+      TemporalNetwork InferredNetwork;
      
       TFlt Window, TotalTime, Delta; 
       TFlt Gamma, Aging;
@@ -24,19 +26,25 @@ class InfoPathModel {
       PGD<AdditiveRiskParameter> pgd;
 
       void LoadCascadesTxt(const TStr& InFNm);
+      void LoadCascadesBin(const TStr& InFNm);
       void LoadGroundTruthTxt(const TStr& InFNm);
       void SaveInferred(const TStr& OutFNm);
 
       void SetModel(const TModel& model) { nodeInfo.Model = model; }
       void SetWindow(const double& window) { Window = window; }
       void SetObservedWindow(const double& window) { additiveRiskFunctionConfigure.observedWindow = window; }
+      void SetSparseSurvival(const bool sparse) { additiveRiskFunctionConfigure.sparseSurvival = sparse; }
+      void SetMinCoOccurrence(const int minCoOccurrence) { additiveRiskFunctionConfigure.minCoOccurrence = minCoOccurrence; }
       void SetDelta(const double& delta) { Delta = delta; }
 
       void SetLearningRate(const double& lr) { pGDConfigure.learningRate = lr; }
       void SetBatchSize(const size_t batchSize) { pGDConfigure.batchSize = batchSize;}
       void SetSampling(const TSampling sampling) {pGDConfigure.sampling = sampling;} 
       void SetParamSampling(const TStr paramSampling) {pGDConfigure.ParamSampling = paramSampling;}
+      void SetEpochs(const bool epochs) { pGDConfigure.epochs = epochs;}
+      void SetOptimizer(const TOptimizer optimizer) { pGDConfigure.optimizer = optimizer;}
       void SetMaxIterNm(const size_t maxIterNm) { pGDConfigure.maxIterNm = maxIterNm;}
+      void SetAsync(const bool async) { pGDConfigure.async = async;}
 
       void SetAging(const double& aging) { Aging = aging; }
       void SetRegularizer(const TRegularizer& reg) { additiveRiskFunctionConfigure.Regularizer = reg; }
@@ -47,7 +55,7 @@ class InfoPathModel {
       void SetInitAlpha(const double& ia) { additiveRiskFunctionConfigure.InitAlpha = ia; }
 
       void Init();
-      int GetCascs() { return CascH.Len(); }
+      int GetCascs() { return CascStore.Len(); }
       void Infer(const TFltV&);
 };
 
@@ -3,9 +3,38 @@
 
 #include <cascdynetinf.h>
 
+// Draws cascade indices in [0, range). The parameters of the sampling are
+// parsed once, in set. EXP and RAY draw from the exponential and Rayleigh
+// distributions truncated to [0, range) by inverting their CDF, one uniform
+// per index. In epoch mode the batch draws are consecutive shuffles of
+// [0, range) instead, so every index is drawn once per epoch, without
+// replacement.
 class InfoPathSampler {
    public:
-      static int sample(const TSampling& Sampling, const TStr& ParamSampling, const int range);
+      InfoPathSampler() : Sampling(UNIF_SAMPLING), Scale(0.0), Epochs(false) {}
+      InfoPathSampler(const TSampling& sampling, const TStr& ParamSampling) : Epochs(false) { set(sampling, ParamSampling); }
+
+      void set(const TSampling& sampling, const TStr& ParamSampling);
+      void setEpochs(const bool epochs) { Epochs = epochs; }
+      bool IsEpochs() const { return Epochs; }
+
+      int sample(const int range) const { return sample(range, TInt::Rnd, TFlt::Rnd); }
+      int sample(const int range, TRnd& Rnd) const { return sample(range, Rnd, Rnd); }
+      // Fills indices with sampleNm draws: as many single draws in a row, or
+      // in epoch mode whole shuffles of [0, range), the last one cut short.
+      // indices is left empty when range is 0.
+      void sample(const int range, const int sampleNm, TIntV& indices) const { sample(range, sampleNm, indices, TInt::Rnd, TFlt::Rnd); }
+      void sample(const int range, const int sampleNm, TIntV& indices, TRnd& Rnd) const { sample(range, sampleNm, indices, Rnd, Rnd); }
+
+   private:
+      int sample(const int range, TRnd& IntRnd, TRnd& FltRnd) const;
+      void sample(const int range, const int sampleNm, TIntV& indices, TRnd& IntRnd, TRnd& FltRnd) const;
+      void shuffle(const int range, const int sampleNm, TIntV& indices, TRnd& IntRnd) const;
+
+      TSampling Sampling;
+      // rate of the exponential, sigma of the Rayleigh
+      TFlt Scale;
+      bool Epochs;
 };
 
 #endif
@@ -3,6 +3,8 @@
 
 #include <EM.h>
 #include <TimeShapingFunction.h>
+#include <EdgeIndex.h>
+#include <CompiledCascades.h>
 
 typedef struct {
    TFlt Tol, InitAlpha, MaxAlpha, MinAlpha;
@@ -21,7 +23,7 @@ class MMRateParameter {
       MMRateParameter& operator = (const MMRateParameter&);
       MMRateParameter& operator += (const MMRateParameter&);
       MMRateParameter& operator *= (const TFlt);
-      MMRateParameter& projectedlyUpdateGradient(const MMRateParameter&);
+      MMRateParameter& projectedlyUpdateGradient(const MMRateParameter&, const Optimizer& optimizer = Optimizer());
       void set(MMRateFunctionConfigure configure);
       void reset();
 
@@ -30,7 +32,8 @@ class MMRateParameter {
       TRegularizer Regularizer;
       TFlt Mu;
       TInt latentVariableSize;   
-      THash<TInt, THash<TIntPr,TFlt> > kAlphas;
+      THash<TInt, EdgeAlphas> kAlphas;
+      THash<TInt, EdgeMoments> kMoments;
       THash<TInt,TFlt> diffusionPatterns; 
       THash<TInt,TFlt> kPi, kPi_times;
 };
@@ -38,14 +41,20 @@ class MMRateParameter {
 class MMRateFunction : public EMLikelihoodFunction<MMRateParameter> {
    public:
       TFlt JointLikelihood(Datum datum, TInt latentVariable) const;
+      void JointLikelihoodAllTopics(Datum datum, double *jointLikelihoods) const;
       void maximize();
-      MMRateParameter& gradient(Datum datum);
+      void gradient(Datum datum, MMRateParameter& grad) const;
+      void prefetch(Datum datum) const { compiledCascades.Prefetch(datum); }
       void set(MMRateFunctionConfigure configure);
       void initPotentialEdges(Data);
 
       TimeShapingFunction *shapingFunction; 
       TFlt observedWindow;
-      THash<TIntPr,TFlt> potentialEdges;
+      bool sparseSurvival;
+      int minCoOccurrence;
+      EdgeIndex potentialEdges;
+      EdgeSchedule edgeSchedule;
+      CompiledCascades compiledCascades;
 };
 
 #endif
@@ -12,9 +12,12 @@ class MMRateModel {
       NodeInfo nodeInfo;
       EdgeInfo edgeInfo;
       THash<TInt, TCascade> CascH;
-      TStrFltFltHNEDNet Network, InferredNetwork, MaxNetwork; 
+      CascadeStore CascStore;
+      TStrFltFltHNEDNet Network;
+      TemporalNetwork InferredNetwork, MaxNetwork;
      
       TFlt Window, TotalTime, Delta; 
+      TBool BinaryEdges;
       TFlt Gamma, Aging;
 
       MMRateFunctionConfigure mMRateFunctionConfigure;
@@ -24,6 +27,7 @@ class MMRateModel {
       EM<MMRateParameter> em;
 
       void LoadCascadesTxt(const TStr& InFNm);
+      void LoadCascadesBin(const TStr& InFNm);
       void LoadGroundTruthTxt(const TStr& InFNm);
       void SaveInferred(const TStr& OutFNm);
       void SaveDiffusionPatterns(const TStr& OutFNm);
@@ -31,13 +35,18 @@ class MMRateModel {
       void SetLatentVariableSize(const TInt size) { mMRateFunctionConfigure.latentVariableSize = eMConfigure.latentVariableSize = size;}
       void SetModel(const TModel& model) { nodeInfo.Model = model; }
       void SetWindow(const double& window) { Window = window; }
+      void SetBinaryEdges(const bool binaryEdges) { BinaryEdges = binaryEdges; }
       void SetObservedWindow(const double& window) { lossFunction.observedWindow = window; }
+      void SetSparseSurvival(const bool sparse) { lossFunction.sparseSurvival = sparse; }
+      void SetMinCoOccurrence(const int minCoOccurrence) { lossFunction.minCoOccurrence = minCoOccurrence; }
       void SetDelta(const double& delta) { Delta = delta; }
 
       void SetLearningRate(const double& lr) { eMConfigure.pGDConfigure.learningRate = lr; }
       void SetBatchSize(const size_t batchSize) { eMConfigure.pGDConfigure.batchSize = batchSize;}
       void SetSampling(const TSampling sampling) { eMConfigure.pGDConfigure.sampling = sampling;} 
       void SetParamSampling(const TStr paramSampling) { eMConfigure.pGDConfigure.ParamSampling = paramSampling;}
+      void SetEpochs(const bool epochs) { eMConfigure.pGDConfigure.epochs = epochs;}
+      void SetOptimizer(const TOptimizer optimizer) { eMConfigure.pGDConfigure.optimizer = optimizer;}
       void SetMaxIterNm(const size_t maxIterNm) { eMConfigure.pGDConfigure.maxIterNm = maxIterNm;}
       void SetEMMaxIterNm(const size_t maxIterNm) { eMConfigure.maxIterNm = maxIterNm;}
 
@@ -53,7 +62,7 @@ class MMRateModel {
       void SetInitDiffusionPattern(const double& id) { mMRateFunctionConfigure.InitDiffusionPattern = id; }
 
       void Init();
-      int GetCascs() { return CascH.Len(); }
+      int GetCascs() { return CascStore.Len(); }
       void Infer(const TFltV&, const TStr& OutFNm);
 };
 
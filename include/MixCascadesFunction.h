@@ -17,27 +17,30 @@ class MixCascadesParameter {
       MixCascadesParameter& operator = (const MixCascadesParameter&);
       MixCascadesParameter& operator += (const MixCascadesParameter&);
       MixCascadesParameter& operator *= (const TFlt);
-      MixCascadesParameter& projectedlyUpdateGradient(const MixCascadesParameter&);
+      MixCascadesParameter& projectedlyUpdateGradient(const MixCascadesParameter&, const Optimizer& optimizer = Optimizer());
       void initKPiParameter();
       void init(TInt latentVariableSize);
       void set(MixCascadesFunctionConfigure configure);
       void reset();
 
       THash<TInt,TFlt> kPi, kPi_times;
-      THash<TInt,AdditiveRiskFunction> kAlphas;
+      THash<TInt,AdditiveRiskParameter> kAlphas;
 };
 
 class MixCascadesFunction : public EMLikelihoodFunction<MixCascadesParameter> {
    public:
       TFlt JointLikelihood(Datum datum, TInt latentVariable) const;
       void maximize();
-      MixCascadesParameter& gradient(Datum datum);
+      void gradient(Datum datum, MixCascadesParameter& grad) const;
+      void accumulateStatistics(Datum datum);
       void set(MixCascadesFunctionConfigure configure);
       void init(TInt latentVariableSize);
       void initKPiParameter();
       void initPotentialEdges(Data);
 
-      THash<TIntPr,TFlt> potentialEdges;
+      // One potential-edge index and one set of compiled cascades shared by
+      // all topics; the topics only differ in their alphas in kAlphas.
+      AdditiveRiskFunction additiveRiskFunction;
 };
 
 #endif
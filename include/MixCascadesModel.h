@@ -12,9 +12,12 @@ class MixCascadesModel {
       NodeInfo nodeInfo;
       EdgeInfo edgeInfo;
       THash<TInt, TCascade> CascH;
-      TStrFltFltHNEDNet Network, InferredNetwork, MaxNetwork; 
+      CascadeStore CascStore;
+      TStrFltFltHNEDNet Network;
+      TemporalNetwork InferredNetwork, MaxNetwork;
      
       TFlt Window, TotalTime, Delta; 
+      TBool BinaryEdges;
       TFlt Gamma, Aging;
 
       MixCascadesFunctionConfigure mixCascadesFunctionConfigure;
@@ -24,19 +27,25 @@ class MixCascadesModel {
       EM<MixCascadesParameter> em;
 
       void LoadCascadesTxt(const TStr& InFNm);
+      void LoadCascadesBin(const TStr& InFNm);
       void LoadGroundTruthTxt(const TStr& InFNm);
       void SaveInferred(const TStr& OutFNm);
 
       void SetLatentVariableSize(const TInt size) { mixCascadesFunctionConfigure.latentVariableSize = eMConfigure.latentVariableSize = size;}
       void SetModel(const TModel& model) { nodeInfo.Model = model; }
       void SetWindow(const double& window) { Window = window; }
+      void SetBinaryEdges(const bool binaryEdges) { BinaryEdges = binaryEdges; }
       void SetObservedWindow(const double& window) { mixCascadesFunctionConfigure.configure.observedWindow = window; }
+      void SetSparseSurvival(const bool sparse) { mixCascadesFunctionConfigure.configure.sparseSurvival = sparse; }
+      void SetMinCoOccurrence(const int minCoOccurrence) { mixCascadesFunctionConfigure.configure.minCoOccurrence = minCoOccurrence; }
       void SetDelta(const double& delta) { Delta = delta; }
 
       void SetLearningRate(const double& lr) { eMConfigure.pGDConfigure.learningRate = lr; }
       void SetBatchSize(const size_t batchSize) { eMConfigure.pGDConfigure.batchSize = batchSize;}
       void SetSampling(const TSampling sampling) { eMConfigure.pGDConfigure.sampling = sampling;} 
       void SetParamSampling(const TStr paramSampling) { eMConfigure.pGDConfigure.ParamSampling = paramSampling;}
+      void SetEpochs(const bool epochs) { eMConfigure.pGDConfigure.epochs = epochs;}
+      void SetOptimizer(const TOptimizer optimizer) { eMConfigure.pGDConfigure.optimizer = optimizer;}
       void SetMaxIterNm(const size_t maxIterNm) { eMConfigure.pGDConfigure.maxIterNm = maxIterNm;}
       void SetEMMaxIterNm(const size_t maxIterNm) { eMConfigure.maxIterNm = maxIterNm;}
 
@@ -49,7 +58,7 @@ class MixCascadesModel {
       void SetInitAlpha(const double& ia) { mixCascadesFunctionConfigure.configure.InitAlpha = ia; }
 
       void Init();
-      int GetCascs() { return CascH.Len(); }
+      int GetCascs() { return CascStore.Len(); }
       void Infer(const TFltV&, const TStr& OutFNm);
 };
 
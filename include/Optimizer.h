@@ -0,0 +1,48 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <cascdynetinf.h>
+
+typedef enum {
+   SGD_OPTIMIZER,
+   ADAGRAD_OPTIMIZER,
+   RMSPROP_OPTIMIZER,
+   ADAM_OPTIMIZER
+} TOptimizer;
+
+// Optimizer state of a set of per-edge values, by edge id like the
+// EdgeAlphas it belongs to: the running first and second moments of the
+// gradient. Grows on demand and stays empty under SGD.
+class EdgeMoments {
+   public:
+      void Reserve(const int edgeNm);
+      void Clr() { first.Clr(); second.Clr(); }
+
+      TFltV first, second;
+};
+
+// Update rule of the projected gradient steps. PGD and EM hand it to
+// projectedlyUpdateGradient, which asks GetStep for the step of every edge in
+// the gradient and then applies the regularizer and the clipping as before.
+// Gradients come in scaled by learningRate/batchSize, as PGD builds them;
+// under SGD the step is the scaled gradient itself.
+class Optimizer {
+   public:
+      Optimizer() : type(SGD_OPTIMIZER), learningRate(1.0), stepNm(0), firstCorrection(1.0), secondCorrection(1.0) {}
+      void set(const TOptimizer optimizerType, const double rate);
+      // once per batch, before the parameter is updated
+      void NextStep();
+      bool IsAdaptive() const { return type != SGD_OPTIMIZER; }
+      double GetStep(EdgeMoments& moments, const int edgeId, const double scaledGradient) const;
+
+   private:
+      static const double Beta1, Beta2, Decay, Eps;
+
+      TOptimizer type;
+      double learningRate;
+      int stepNm;
+      // Adam bias corrections, 1 - beta^stepNm
+      double firstCorrection, secondCorrection;
+};
+
+#endif
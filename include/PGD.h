@@ -1,9 +1,11 @@
 #ifndef PGD_H
 #define PGD_H
 
+#include <omp.h>
 #include <Parameter.h>
 #include <cascdynetinf.h>
 #include <InfoPathSampler.h>
+#include <Optimizer.h>
 
 template <typename T>
 class PGDFunction;
@@ -13,6 +15,11 @@ struct PGDConfigure {
    TFlt learningRate;
    TSampling sampling;
    TStr ParamSampling;
+   // lock-free updates; they draw with sampling and take plain SGD steps
+   bool async;
+   // shuffled epochs of cascades instead of i.i.d. draws
+   bool epochs;
+   TOptimizer optimizer;
 };
 
 template <typename T>
@@ -20,32 +27,53 @@ class PGD {
    public:
       void set(PGDConfigure c) { 
          configure = c;
+         EAssertR(!c.async || (!c.epochs && c.optimizer == SGD_OPTIMIZER), "Asynchronous updates support neither epochs nor adaptive optimizers");
+         sampler.set(c.sampling, c.ParamSampling);
+         sampler.setEpochs(c.epochs);
+         optimizer.set(c.optimizer, c.learningRate);
       }
 
       void Optimize(PGDFunction<T> &f, Data data) {
+         // a step with no eligible cascades leaves the parameter as it is
+         if (data.cascadesPositions.Empty()) {
+            iterNm = configure.maxIterNm;
+            return;
+         }
+
+         if (configure.async && f.beginAsync()) {
+            OptimizeAsync(f, data);
+            f.endAsync();
+            return;
+         }
+
          iterNm = 0;
       
-         double time = data.time;
-         THash<TInt, TCascade> &cascH = data.cascH;
          TIntFltH &cascadesIdx = data.cascadesPositions;
          size_t scale = configure.maxIterNm / 5;
          TIntFltH sampledCascadesPositions;
          T learningRate;
+         TIntV indices;
+         sampler.sample(cascadesIdx.Len(), configure.maxIterNm * configure.batchSize, indices);
+         int next = 0;
       
          while(!IsTerminate()) { 
             T parameterDiff;
+            TIntV batch;
             for (size_t i=0;i<configure.batchSize;i++) {
-               int index = InfoPathSampler::sample(configure.sampling, configure.ParamSampling, cascadesIdx.Len());
+               int index = indices[next++];
                sampledCascadesPositions.AddDat(cascadesIdx.GetKey(index), 0.0);
-               Datum datum = {data.NodeNmH, cascH, cascH.GetKey(cascadesIdx.GetKey(index)), time};
-               parameterDiff += f.gradient(datum);
+               batch.Add(cascadesIdx.GetKey(index));
             }
+            TIntV nextBatch;
+            for (size_t i=0;i<configure.batchSize && next+(int)i<indices.Len();i++) nextBatch.Add(cascadesIdx.GetKey(indices[next+i]));
+            f.batchGradient(data, batch, parameterDiff, nextBatch);
             parameterDiff *= (configure.learningRate/double(configure.batchSize));
-            f.parameter.projectedlyUpdateGradient(parameterDiff);
+            optimizer.NextStep();
+            f.parameter.projectedlyUpdateGradient(parameterDiff, optimizer);
             iterNm++;
             if (iterNm % scale == 0) {
                double size = (double) sampledCascadesPositions.Len();
-               Data sampleData = {data.NodeNmH, data.cascH, sampledCascadesPositions, data.time};
+               Data sampleData = {data.NodeNmH, data.cascades, sampledCascadesPositions, data.time};
                loss = f.loss(sampleData)/size;
                printf("iterNm: %d, loss: %f\033[0K\r",(int)iterNm,loss());
                fflush(stdout);
@@ -59,27 +87,110 @@ class PGD {
       }
    private:
       PGDConfigure configure;
+      InfoPathSampler sampler;
+      Optimizer optimizer;
       size_t iterNm;
       TFlt loss;
+
+      // Hogwild style: every thread samples its own cascades and writes the
+      // projected step of each one straight into the shared parameter,
+      // without a barrier between batches. The same number of cascades is
+      // visited as in the synchronous run, each with learningRate/batchSize.
+      void OptimizeAsync(PGDFunction<T> &f, Data data) {
+         TIntFltH &cascadesIdx = data.cascadesPositions;
+         long long updateNm = (long long)configure.maxIterNm * configure.batchSize;
+         TFlt learningRate = configure.learningRate/double(configure.batchSize);
+         TExeTm ExeTm;
+
+         #pragma omp parallel
+         {
+            TRnd rnd(omp_get_thread_num() + 1);
+            T grad;
+            #pragma omp for schedule(dynamic,16)
+            for (long long i=0;i<updateNm;i++) {
+               int index = sampler.sample(cascadesIdx.Len(), rnd);
+               int position = cascadesIdx.GetKey(index);
+               Datum datum = {data.NodeNmH, data.cascades, data.cascades.GetCId(position), position, data.time};
+               f.updateAsync(datum, grad, learningRate);
+            }
+         }
+
+         double secs = ExeTm.GetSecs();
+         iterNm = configure.maxIterNm;
+         loss = f.loss(data)/(double)cascadesIdx.Len();
+         printf("async updates: %lld, updates/s: %.1f, loss: %f\n", updateNm, secs > 0.0 ? updateNm/secs : 0.0, loss());
+         fflush(stdout);
+      }
 };
 
 template<typename T> 
 class PGDFunction {
    friend class PGD<T>;
    public:
-      virtual T& gradient(Datum datum) = 0;
+      // Writes the gradient of one cascade into grad. It must not touch the
+      // function's own state, since the cascades of a mini-batch are handled
+      // concurrently. Statistics that are kept in the function instead of
+      // the gradient are collected by accumulateStatistics.
+      virtual void gradient(Datum datum, T& grad) const = 0;
+      virtual void accumulateStatistics(Datum datum) {}
+      // Hooks for the asynchronous mode of PGD. updateAsync applies the
+      // projected step of one cascade to the shared parameter and runs on
+      // several threads at once. Functions that keep the default
+      // beginAsync are optimized synchronously.
+      virtual bool beginAsync() { return false; }
+      virtual void updateAsync(Datum datum, T& grad, const TFlt learningRate) {}
+      virtual void endAsync() {}
       virtual TFlt loss(Datum datum) const = 0;
-      virtual void calculateRMSProp(TFlt, T&, T&) {}
+      // Starts loading what gradient will read for the cascade into the
+      // cache. Functions that precompute cascades prefetch their own copy.
+      virtual void prefetch(Datum datum) const { datum.cascades.Prefetch(datum.position); }
       TFlt loss(Data data) const {
          TFlt totalLoss = 0.0;
          TIntFltH &cascadesPositions = data.cascadesPositions;
          for (TIntFltH::TIter CI = cascadesPositions.BegI(); !CI.IsEnd(); CI++) {
             TInt index = CI.GetKey();
-            Datum datum = {data.NodeNmH, data.cascH, data.cascH.GetKey(index), data.time};
+            Datum datum = {data.NodeNmH, data.cascades, data.cascades.GetCId(index), index, data.time};
             totalLoss += loss(datum);
          } 
          return totalLoss;
       }
+      // Adds the gradients of the cascades at the given store positions into
+      // batchGrad. Each thread sums its share of the batch into its own
+      // buffer and the buffers are added in thread order, so the result does
+      // not depend on scheduling. A single cascade keeps the parallel loops
+      // inside gradient(). While a thread works on a cascade it prefetches
+      // the next one it will get, from nextBatch after its last one; the
+      // static schedule hands thread t the same slots in every batch.
+      void batchGradient(Data data, const TIntV& batch, T& batchGrad, const TIntV& nextBatch = TIntV()) {
+         int batchSize = batch.Len();
+         for (int i=0;i<batchSize;i++) {
+            Datum datum = {data.NodeNmH, data.cascades, data.cascades.GetCId(batch[i]), batch[i], data.time};
+            accumulateStatistics(datum);
+         }
+
+         int threadNm = omp_get_max_threads();
+         if (threadNm > batchSize) threadNm = batchSize;
+         TVec<T> threadGrads(threadNm);
+
+         #pragma omp parallel for schedule(static,1) num_threads(threadNm) if(threadNm > 1)
+         for (int t=0;t<threadNm;t++) {
+            T datumGrad;
+            for (int i=t;i<batchSize;i+=threadNm) {
+               int next = -1;
+               if (i + threadNm < batchSize) next = batch[i + threadNm];
+               else if (t < nextBatch.Len()) next = nextBatch[t];
+               if (next != -1) {
+                  Datum nextDatum = {data.NodeNmH, data.cascades, data.cascades.GetCId(next), next, data.time};
+                  prefetch(nextDatum);
+               }
+               Datum datum = {data.NodeNmH, data.cascades, data.cascades.GetCId(batch[i]), batch[i], data.time};
+               gradient(datum, datumGrad);
+               threadGrads[t] += datumGrad;
+            }
+         }
+
+         for (int t=0;t<threadNm;t++) batchGrad += threadGrads[t];
+      }
       const T& getParameter() const { return parameter;}
       const T& getParameterGrad() const { return parameterGrad;}
       T& getParameter() { return parameter;}
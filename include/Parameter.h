@@ -2,17 +2,20 @@
 #define PARAMETER_H
 
 #include <cascdynetinf.h>
+#include <CascadeStore.h>
 
+// index is the id of the cascade, position its position in the store.
 struct Datum {
    THash<TInt, TNodeInfo> &NodeNmH;
-   THash<TInt, TCascade> &cascH;
+   const CascadeStore &cascades;
    TInt index;
+   int position;
    double time;
 };
 
 struct Data {
    THash<TInt, TNodeInfo> &NodeNmH;
-   THash<TInt, TCascade> &cascH;
+   const CascadeStore &cascades;
    TIntFltH &cascadesPositions;
    double time;
 };
@@ -0,0 +1,52 @@
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <cascdynetinf.h>
+
+// One record of a binary edge list: a flat array of these, in the order the
+// edges were written to the text file.
+typedef struct {
+   int srcNId, dstNId;
+   double time, alpha;
+}EdgeRecord;
+
+// Writer of network files that keeps one handle open per file and formats
+// into a large buffer, which is written out whenever it fills up. Numbers are
+// formatted by hand instead of with TStr::Fmt; PutFlt prints like "%f". With
+// binaryEdges, PutEdge also appends an EdgeRecord to <OutFNm>.bin.
+class ResultWriter {
+   public:
+      ResultWriter(const TStr& OutFNm, const bool binaryEdges = false, const bool append = false);
+      ~ResultWriter();
+
+      void PutCh(const char ch) { Reserve(1); bf[bfLen++] = ch; }
+      void PutStr(const char *str);
+      void PutStr(const TStr& str) { PutStr(str.CStr()); }
+      void PutInt(const int val);
+      void PutFlt(const double val);
+
+      // "NId,name" lines of every node followed by an empty line
+      void PutNodes(const THash<TInt, TNodeInfo>& NodeNmH, const char *lineEnd = "\n");
+      // "srcNId,dstNId,time,alpha" line
+      void PutEdge(const int srcNId, const int dstNId, const double time, const double alpha);
+      // "CId;NId,time,NId,time..." line of the hits of C whose node is in
+      // NodeNmH, nothing if there is none
+      void PutCascade(const TCascade& C, const THash<TInt, TNodeInfo>& NodeNmH);
+      void Flush();
+
+   private:
+      ResultWriter(const ResultWriter&);
+      ResultWriter& operator=(const ResultWriter&);
+
+      void Reserve(const int len) { if (bfLen + len > BfL) Flush(); }
+
+      static const int BfL = 1 << 22;
+      static const int RecordBfL = 1 << 16;
+      FILE *file, *binFile;
+      char *bf;
+      int bfLen;
+      EdgeRecord *records;
+      int recordNm;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TEMPORALNETWORK_H
+#define TEMPORALNETWORK_H
+
+#include <cascdynetinf.h>
+#include <EdgeIndex.h>
+
+// Network with one alpha per edge and time step, stored as a steps x edges
+// matrix: a shared, increasing step axis, an EdgeIndex for the edge ids and
+// one EdgeAlphas row per step, whose set flags mark which edges have a value
+// at that step. Replaces the TFltFltH per edge of a TStrFltFltHNEDNet, so an
+// update is two array accesses after one edge lookup.
+class TemporalNetwork {
+   public:
+      // Steps must be added in increasing time; adding the last one again
+      // returns its index.
+      int AddStep(const double time);
+      int GetStepIdx(const double time) const;
+      int GetSteps() const { return steps.Len(); }
+      double GetStep(const int step) const { return steps[step]; }
+      const TFltV& GetStepV() const { return steps; }
+
+      TInt AddEdge(const TInt srcNId, const TInt dstNId) { return edges.AddEdge(srcNId, dstNId); }
+      TInt GetEdgeId(const TInt srcNId, const TInt dstNId) const { return edges.GetEdgeId(srcNId, dstNId); }
+      bool IsEdge(const TInt srcNId, const TInt dstNId) const { return edges.IsEdge(srcNId, dstNId); }
+      const TIntPr& GetEdge(const TInt edgeId) const { return edges.GetEdge(edgeId); }
+      int GetEdges() const { return edges.Len(); }
+
+      bool IsDat(const int step, const TInt edgeId) const { return step != -1 && alphas[step].IsKey(edgeId); }
+      // 0 where the edge has no value at the step
+      TFlt GetDat(const int step, const TInt edgeId) const { return alphas[step].GetDat(edgeId, 0.0); }
+      TFlt& GetDat(const int step, const TInt edgeId) { return alphas[step].GetDat(edgeId); }
+      TFlt& AddDat(const int step, const TInt edgeId, const TFlt value) { return alphas[step].AddDat(edgeId, value); }
+      const EdgeAlphas& GetStepAlphas(const int step) const { return alphas[step]; }
+
+      // Replaces the contents with the edges and alphas of Network.
+      void FromNetwork(const TStrFltFltHNEDNet& Network);
+      void Clr();
+
+   private:
+      TFltV steps;
+      THash<TFlt, TInt> stepIdxH;
+      EdgeIndex edges;
+      TVec<EdgeAlphas> alphas;
+};
+
+#endif
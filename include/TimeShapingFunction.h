@@ -2,6 +2,7 @@
 #define TIMESHAPINGFUNCTION_H
 
 #include <cascdynetinf.h>
+#include <BatchMath.h>
 
 class TimeShapingFunction {
    public:
@@ -11,6 +12,7 @@ class TimeShapingFunction {
       virtual bool Before(TFlt srcTime,TFlt dstTime) const = 0;
       virtual TFlt expectedAlpha(TFlt) const = 0;
       virtual TFlt pValue(TFlt, TFlt, TFlt) const = 0;
+      virtual TModel GetModel() const = 0;
 };
 
 class EXPShapingFunction : public TimeShapingFunction {
@@ -20,6 +22,9 @@ class EXPShapingFunction : public TimeShapingFunction {
      bool Before(TFlt srcTime,TFlt dstTime) const;
      TFlt expectedAlpha(TFlt) const;
      TFlt pValue(TFlt, TFlt, TFlt) const;
+     TModel GetModel() const { return EXP; }
+     void ValueV(const double *dt, double *value, const int n) const;
+     void IntegralV(const double *dt, double *integral, const int n) const;
 };
 
 class POWShapingFunction : public TimeShapingFunction {
@@ -30,6 +35,9 @@ class POWShapingFunction : public TimeShapingFunction {
      bool Before(TFlt srcTime,TFlt dstTime) const;
      TFlt expectedAlpha(TFlt) const;
      TFlt pValue(TFlt, TFlt, TFlt) const;
+     TModel GetModel() const { return POW; }
+     void ValueV(const double *dt, double *value, const int n) const;
+     void IntegralV(const double *dt, double *integral, const int n) const;
 
      TFlt delta;
 };
@@ -41,5 +49,85 @@ class RAYShapingFunction : public TimeShapingFunction {
      bool Before(TFlt srcTime,TFlt dstTime) const;
      TFlt expectedAlpha(TFlt) const;
      TFlt pValue(TFlt, TFlt, TFlt) const;
+     TModel GetModel() const { return RAY; }
+     void ValueV(const double *dt, double *value, const int n) const;
+     void IntegralV(const double *dt, double *integral, const int n) const;
 };
+
+// Value, Integral and Before are defined here so that the kernels which are
+// instantiated per shaping model (see CompiledCascades) can inline them.
+// ValueV and IntegralV evaluate a whole vector of time differences
+// dstTime - srcTime at once; every pair must satisfy Before.
+inline TFlt EXPShapingFunction::Value(TFlt srcTime,TFlt dstTime) const {
+   if (srcTime < dstTime) return 1.0;
+   else return 0.0;
+}
+
+inline TFlt EXPShapingFunction::Integral(TFlt srcTime,TFlt dstTime) const {
+   if (srcTime < dstTime) return dstTime - srcTime;
+   else return 0.0;
+}
+
+inline bool EXPShapingFunction::Before(TFlt srcTime,TFlt dstTime) const {
+   return srcTime < dstTime;
+}
+
+inline void EXPShapingFunction::ValueV(const double *dt, double *value, const int n) const {
+   #pragma omp simd
+   for (int i=0; i<n; i++) value[i] = 1.0;
+}
+
+inline void EXPShapingFunction::IntegralV(const double *dt, double *integral, const int n) const {
+   #pragma omp simd
+   for (int i=0; i<n; i++) integral[i] = dt[i];
+}
+
+inline TFlt POWShapingFunction::Value(TFlt srcTime,TFlt dstTime) const {
+   if (POWShapingFunction::Before(srcTime, dstTime)) return 1.0 / (dstTime - srcTime);
+   else return 0.0;
+}
+
+inline TFlt POWShapingFunction::Integral(TFlt srcTime,TFlt dstTime) const {
+   if (POWShapingFunction::Before(srcTime, dstTime)) return TMath::Log((dstTime - srcTime) / delta);
+   else return 0.0;
+}
+
+inline bool POWShapingFunction::Before(TFlt srcTime,TFlt dstTime) const {
+   return (srcTime + delta) < dstTime;
+}
+
+inline void POWShapingFunction::ValueV(const double *dt, double *value, const int n) const {
+   #pragma omp simd
+   for (int i=0; i<n; i++) value[i] = 1.0 / dt[i];
+}
+
+inline void POWShapingFunction::IntegralV(const double *dt, double *integral, const int n) const {
+   const double d = delta;
+   #pragma omp simd
+   for (int i=0; i<n; i++) integral[i] = log(dt[i] / d);
+}
+
+inline TFlt RAYShapingFunction::Value(TFlt srcTime,TFlt dstTime) const {
+   if (srcTime < dstTime) return dstTime - srcTime;
+   else return 0.0;
+}
+
+inline TFlt RAYShapingFunction::Integral(TFlt srcTime,TFlt dstTime) const {
+   if (srcTime < dstTime) return TMath::Power(dstTime - srcTime, 2.0) / 2.0;
+   else return 0.0;
+}
+
+inline bool RAYShapingFunction::Before(TFlt srcTime,TFlt dstTime) const {
+   return srcTime < dstTime;
+}
+
+inline void RAYShapingFunction::ValueV(const double *dt, double *value, const int n) const {
+   #pragma omp simd
+   for (int i=0; i<n; i++) value[i] = dt[i];
+}
+
+inline void RAYShapingFunction::IntegralV(const double *dt, double *integral, const int n) const {
+   #pragma omp simd
+   for (int i=0; i<n; i++) integral[i] = dt[i] * dt[i] / 2.0;
+}
 #endif
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+scriptName=`basename $0`
+expName=${scriptName:0:${#scriptName}-3}
+
+cascSuffix="-cascades.txt"
+netSuffix="-network.txt"
+
+cascName="data/""$expName"
+
+minAlpha="0.0"
+maxAlpha="0.2"
+nodeNm="1024"
+edgeNm="2048"
+threadNms="1 2 4 8 16 32"
+
+./bin/generate_FASTEN_nets -g:"0.987 0.571;0.571 0.049" -ar:"0.05;""$maxAlpha" -c:5000 -f:"$cascName" -n:"$nodeNm" -e:"$edgeNm" -K:3 -m:0 
+
+FASTENOut="result/""$expName""-FASTEN"
+
+TIMEFORMAT="%R"
+baseTime=""
+echo "threads seconds speedup"
+for threadNm in $threadNms; do
+   runTime=$( { time OMP_NUM_THREADS="$threadNm" ./bin/FASTEN -i:"$cascName""$cascSuffix" -n:"$cascName""$netSuffix" -o:"$FASTENOut" -rm:3 -la:"$minAlpha" -ua:"$maxAlpha" -s:0 -K:3 -em:10 -e:100 -bl:10 -g:0.005 -w:5 -m:0 > /dev/null; } 2>&1 )
+   if [ -z "$baseTime" ]; then baseTime="$runTime"; fi
+   awk -v t="$threadNm" -v s="$runTime" -v b="$baseTime" 'BEGIN { printf "%d %.2f %.2f\n", t, s, b/s }'
+done
@@ -3,164 +3,167 @@
 void AdditiveRiskFunction::set(AdditiveRiskFunctionConfigure configure) {
    shapingFunction = configure.shapingFunction;
    observedWindow = configure.observedWindow;
+   sparseSurvival = configure.sparseSurvival;
+   minCoOccurrence = configure.minCoOccurrence;
    parameter.set(configure);
 }
 
-AdditiveRiskParameter& AdditiveRiskFunction::gradient(Datum datum) {
-   double CurrentTime = datum.time;
-   TCascade &Cascade = datum.cascH.GetDat(datum.index);
-   THash<TInt, TNodeInfo> &NodeNmH = datum.NodeNmH;
-
-   parameterGrad.reset();
-
-   int nodeSize = NodeNmH.Len();
-   int cascadeSize = Cascade.Len();
-   int *srcNIds = new int[nodeSize * cascadeSize];
-   int *dstNIds = new int[nodeSize * cascadeSize];
-   float *vals  = new float[nodeSize * cascadeSize];
- 
-   for (int i=0;i<nodeSize;i++) {
-      for (int j=0;j<cascadeSize;j++) {
-         int index = i*cascadeSize + j;
-         srcNIds[index] = dstNIds[index] = -1;
-         vals[index] = -1.0;
-      }
-   }
+void AdditiveRiskFunction::gradient(Datum datum, AdditiveRiskParameter& grad) const {
+   gradient(datum, parameter, grad);
+}
+
+// The kernels take the parameter explicitly so that several parameters can
+// share one potential-edge index and its compiled cascades (see MixCascades).
+void AdditiveRiskFunction::gradient(Datum datum, const AdditiveRiskParameter& p, AdditiveRiskParameter& grad) const {
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
+
+   grad.reset();
+
+   int dstSize = Cascade.Len();
+   int parentSize = Cascade.GetParentNm();
+   double *vals = new double[parentSize];
 
    #pragma omp parallel for
-   for (int i=0;i<nodeSize;i++) {
-      TInt key = NodeNmH.GetKey(i);
-      THash<TInt, TNodeInfo>::TIter NI = NodeNmH.GetI(key);
-      TInt dstNId = NI.GetKey(), srcNId;
-      TFlt sumInLog = 0.0, val = 0.0;
-      TFlt dstTime, srcTime;
-
-      if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime) {
-         dstTime = Cascade.GetTm(dstNId);
-         for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++) {
-            srcNId = CascadeNI.GetKey();
-            srcTime = CascadeNI.GetDat().Tm;
-
-            if (!shapingFunction->Before(srcTime,dstTime)) break; 
-                        
-            TIntPr alphaIndex; alphaIndex.Val1 = srcNId; alphaIndex.Val2 = dstNId;
-
-            TFlt alpha;
-            if (parameter.alphas.IsKey(alphaIndex)) alpha = parameter.alphas.GetDat(alphaIndex);
-            else alpha = parameter.InitAlpha;
-         
-            sumInLog += alpha * shapingFunction->Value(srcTime,dstTime);
-            //printf("sumInLog:%f, alpha:%f, val:%f, initAlpha:%f\n",sumInLog(),alpha(),shapingFunction->Value(srcTime,dstTime)(),parameter.InitAlpha());
+   for (int i=0;i<dstSize;i++) {
+      int beg = Cascade.GetBeg(i), end = Cascade.GetEnd(i);
+      double sumInLog = 0.0;
+
+      if (Cascade.IsInfected(i)) {
+         for (int j=beg;j<end;j++) {
+            const ParentEntry &parent = Cascade.GetParent(j);
+            sumInLog += p.alphas.GetDat(parent.edgeId, p.InitAlpha) * parent.value;
          }
-      }
-      else dstTime = Cascade.GetMaxTm() + observedWindow; 
-
-      int j=0;
-      for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++,j++) {
-         srcNId = CascadeNI.GetKey();
-         srcTime = CascadeNI.GetDat().Tm;
-
-         if (!shapingFunction->Before(srcTime,dstTime)) break; 
-         TIntPr key(srcNId, dstNId);
-         if (!potentialEdges.IsKey(key)) continue;
-                        
-         TIntPr alphaIndex; alphaIndex.Val1 = srcNId; alphaIndex.Val2 = dstNId;
-         if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime)
-            val = shapingFunction->Integral(srcTime,dstTime) - shapingFunction->Value(srcTime,dstTime)/sumInLog;
-         else {
-            val = shapingFunction->Integral(srcTime,dstTime);
+         for (int j=beg;j<end;j++) {
+            const ParentEntry &parent = Cascade.GetParent(j);
+            vals[j] = parent.integral - parent.value/sumInLog;
          }
-            
-         int index = i*cascadeSize + j;
-         srcNIds[index] = srcNId();
-         dstNIds[index] = dstNId();
-         vals[index] = val();
-         //printf("index:%d, %d,%d: gradient:%f, shapingVal:%f, sumInLog:%f\n",datum.index(),srcNId(),dstNId(),val(),shapingFunction->Integral(srcTime,dstTime)(),sumInLog()); 
+      }
+      else {
+         for (int j=beg;j<end;j++) vals[j] = Cascade.GetParent(j).integral;
       }
    }
 
-   for (int i=0;i<nodeSize;i++) {
-      for (int j=0;j<cascadeSize;j++) {
-         int index = i*cascadeSize + j;
-         if (srcNIds[index]==-1) break;
-         TIntPr alphaIndex; alphaIndex.Val1 = srcNIds[index]; alphaIndex.Val2 = dstNIds[index];
-         parameterGrad.alphas.AddDat(alphaIndex,vals[index]);
-      }
+   for (int j=0;j<parentSize;j++) {
+      int edgeId = Cascade.GetParent(j).edgeId;
+      if (edgeId == -1) continue;
+      grad.alphas.AddDat(edgeId, vals[j]);
    }
 
-   delete[] srcNIds;
-   delete[] dstNIds;
    delete[] vals;
-
-   return parameterGrad;
 }
 
 TFlt AdditiveRiskFunction::loss(Datum datum) const {
-   double CurrentTime = datum.time;
-   TCascade &Cascade = datum.cascH.GetDat(datum.index);
-   THash<TInt, TNodeInfo> &NodeNmH = datum.NodeNmH;
-   TFlt totalLoss = 0.0;
+   return loss(datum, parameter);
+}
 
-   int nodeSize = NodeNmH.Len();
-   float *lossTable = new float[nodeSize];
-   #pragma omp parallel for
-   for (int i=0;i<nodeSize;i++) {
-      TInt key = NodeNmH.GetKey(i);
-      THash<TInt, TNodeInfo>::TIter NI = NodeNmH.GetI(key);
-      TInt dstNId = NI.GetKey(), srcNId;
-      TFlt sumInLog = 0.0, val = 0.0;
-      TFlt dstTime, srcTime;
-      lossTable[i] = 0.0;
-
-      if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime) dstTime = Cascade.GetTm(dstNId);
-      else dstTime = Cascade.GetMaxTm() + observedWindow; 
-
-      for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++) {
-         srcNId = CascadeNI.GetKey();
-         srcTime = CascadeNI.GetDat().Tm;
-
-         if (!shapingFunction->Before(srcTime,dstTime)) break; 
-                        
-         TIntPr alphaIndex; alphaIndex.Val1 = srcNId; alphaIndex.Val2 = dstNId;
-
-         TFlt alpha = 0.0;
-         if (potentialEdges.IsKey(alphaIndex)) {
-            if (parameter.alphas.IsKey(alphaIndex)) alpha = parameter.alphas.GetDat(alphaIndex);
-            else alpha = parameter.InitAlpha;
+TFlt AdditiveRiskFunction::loss(Datum datum, const AdditiveRiskParameter& p) const {
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
+   double totalLoss = 0.0;
+
+   int dstSize = Cascade.Len();
+   double *sumInLogs = new double[dstSize];
+   #pragma omp parallel for reduction(+:totalLoss)
+   for (int i=0;i<dstSize;i++) {
+      double sumInLog = 0.0, val = 0.0;
+
+      for (int j=Cascade.GetBeg(i);j<Cascade.GetEnd(i);j++) {
+         const ParentEntry &parent = Cascade.GetParent(j);
+         if (parent.edgeId == -1) continue;
+
+         double alpha = p.alphas.GetDat(parent.edgeId, p.InitAlpha);
+         sumInLog += alpha * parent.value;
+         val += alpha * parent.integral;
+      }
+
+      sumInLogs[i] = (Cascade.IsInfected(i) && sumInLog!=0.0) ? sumInLog : 1.0;
+      totalLoss += val;
+   }
+   totalLoss -= BatchLogSum(sumInLogs, dstSize);
+   delete[] sumInLogs;
+
+   //printf("datum:%d, Myloss:%f\n",datum.index(), totalLoss);
+   return totalLoss;
+}
+
+// Every potential edge gets a value before the workers start, so their
+// writes never grow the alpha storage. Edges that were neither set before
+// nor updated by a worker are dropped again in endAsync.
+bool AdditiveRiskFunction::beginAsync() {
+   asyncSetNm = parameter.alphas.Len();
+   parameter.alphas.Fill(potentialEdges.Len(), parameter.InitAlpha);
+   asyncTouched.Gen(potentialEdges.Len());
+   asyncTouched.PutAll(0);
+   return true;
+}
+
+// Gradient kernel of updateAsync. Other workers write the shared alphas
+// meanwhile, so each one is read with a relaxed atomic load, and the cascade
+// is walked on the calling thread only.
+void AdditiveRiskFunction::gradientAsync(Datum datum, AdditiveRiskParameter& grad) {
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
+
+   grad.reset();
+
+   for (int i=0;i<Cascade.Len();i++) {
+      int beg = Cascade.GetBeg(i), end = Cascade.GetEnd(i);
+
+      if (!Cascade.IsInfected(i)) {
+         for (int j=beg;j<end;j++) {
+            const ParentEntry &parent = Cascade.GetParent(j);
+            if (parent.edgeId != -1) grad.alphas.AddDat(parent.edgeId, parent.integral);
          }
+         continue;
+      }
 
-         sumInLog += alpha * shapingFunction->Value(srcTime,dstTime);
-         val += alpha * shapingFunction->Integral(srcTime,dstTime);
-         //printf("sumInLog:%f,val:%f, alpha:%f, shapingVal:%f, shapingInt:%f\n",sumInLog(),val(),alpha(),shapingFunction->Value(srcTime,dstTime)(),shapingFunction->Integral(srcTime,dstTime)()); 
+      double sumInLog = 0.0;
+      for (int j=beg;j<end;j++) {
+         const ParentEntry &parent = Cascade.GetParent(j);
+         double alpha = parameter.InitAlpha;
+         if (parent.edgeId != -1) {
+            const double &value = parameter.alphas.GetDat(parent.edgeId).Val;
+            #pragma omp atomic read
+            alpha = value;
+         }
+         sumInLog += alpha * parent.value;
+      }
+      for (int j=beg;j<end;j++) {
+         const ParentEntry &parent = Cascade.GetParent(j);
+         if (parent.edgeId != -1) grad.alphas.AddDat(parent.edgeId, parent.integral - parent.value/sumInLog);
       }
-      lossTable[i] = val;
-      
-      if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime && sumInLog!=0.0) lossTable[i] -= TMath::Log(sumInLog);
-      
    }
+}
 
-   for (int i=0;i<nodeSize;i++) totalLoss += lossTable[i];
-   delete[] lossTable;
+void AdditiveRiskFunction::updateAsync(Datum datum, AdditiveRiskParameter& grad, const TFlt learningRate) {
+   gradientAsync(datum, grad);
+   for (int i=0; i<grad.alphas.Len(); i++) {
+      TInt edgeId = grad.alphas.GetId(i);
+      double &value = parameter.alphas.GetDat(edgeId).Val;
+      double alpha;
+
+      #pragma omp atomic read
+      alpha = value;
+      alpha = parameter.projectAlpha(alpha, learningRate * grad.alphas.GetDat(edgeId));
+      #pragma omp atomic write
+      value = alpha;
+      #pragma omp atomic write
+      asyncTouched[edgeId].Val = 1;
+   }
+}
 
-   //printf("datum:%d, Myloss:%f\n",datum.index(), totalLoss());
-   return totalLoss;
+void AdditiveRiskFunction::endAsync() {
+   EdgeAlphas alphas;
+   for (int i=0; i<parameter.alphas.Len(); i++) {
+      TInt edgeId = parameter.alphas.GetId(i);
+      if (i < asyncSetNm || asyncTouched[edgeId]) alphas.AddDat(edgeId, parameter.alphas.GetDat(edgeId));
+   }
+   parameter.alphas = alphas;
+   asyncTouched.Clr();
 }
 
 void AdditiveRiskFunction::initPotentialEdges(Data data) {
-  THash<TInt, TCascade>& cascades = data.cascH;
-  int cascadesNum = cascades.Len();
-  //#pragma omp parallel for
-  for (int i=0;i<cascadesNum;i++) {
-     TCascade& cascade = cascades[i];
-     for (THash<TInt, THitInfo>::TIter srcNI = cascade.BegI(); srcNI < cascade.EndI(); srcNI++) {
-        for (THash<TInt, THitInfo>::TIter dstNI = srcNI; dstNI < cascade.EndI(); dstNI++) {
-           if (srcNI==dstNI) continue;
-           TIntPr key(srcNI.GetKey(), dstNI.GetKey());
-           if (dstNI.GetDat().Tm <= data.time)
-              potentialEdges.AddDat(key, 1.0);
-        } 
-     }
-  }
+  if (!edgeSchedule.IsBuilt()) edgeSchedule.Build(data.cascades, minCoOccurrence);
+  edgeSchedule.Activate(data.time, potentialEdges);
+  compiledCascades.Compile(data, potentialEdges, shapingFunction, observedWindow, sparseSurvival);
 }
 
 AdditiveRiskParameter::AdditiveRiskParameter() {
@@ -174,44 +177,37 @@ AdditiveRiskParameter& AdditiveRiskParameter::operator = (const AdditiveRiskPara
 }
 
 AdditiveRiskParameter& AdditiveRiskParameter::operator += (const AdditiveRiskParameter& p) {
-   for (THash<TIntPr,TFlt>::TIter AI = p.alphas.BegI(); !AI.IsEnd(); AI++) {
-      TIntPr key = AI.GetKey();
-      TFlt alpha = AI.GetDat();
-      if (!alphas.IsKey(key)) alphas.AddDat(key,alpha);
-      else alphas.GetDat(key) += alpha;
-      //printf("%d,%d: += alpha:%f \n", AI.GetDat()key.Val1(), key.Val2(), AI.GetDat());
-   }
+   alphas += p.alphas;
    return *this; 
 }
 
 AdditiveRiskParameter& AdditiveRiskParameter::operator *= (const TFlt multiplier) {
-   for (THash<TIntPr,TFlt>::TIter AI = alphas.BegI(); !AI.IsEnd(); AI++) {
-      AI.GetDat() *= multiplier;
-   }
+   alphas *= multiplier;
    return *this; 
 }
 
-AdditiveRiskParameter& AdditiveRiskParameter::projectedlyUpdateGradient(const AdditiveRiskParameter& p) {
-   for (THash<TIntPr,TFlt>::TIter AI = p.alphas.BegI(); !AI.IsEnd(); AI++) {
-      TIntPr key = AI.GetKey();
-      TFlt alphaGradient = AI.GetDat(), alpha;
-      //printf("%d,%d: %f, dat:%f, m:%f\n",key.Val1(),key.Val2(),alpha(),AI.GetDat()(),p.multiplier());
-      if (alphas.IsKey(key)) alpha = alphas.GetDat(key); 
-      else alpha = InitAlpha;
+AdditiveRiskParameter& AdditiveRiskParameter::projectedlyUpdateGradient(const AdditiveRiskParameter& p, const Optimizer& optimizer) {
+   for (int i=0; i<p.alphas.Len(); i++) {
+      TInt edgeId = p.alphas.GetId(i);
+      TFlt alphaGradient = optimizer.GetStep(moments, edgeId, p.alphas.GetDat(edgeId));
+      TFlt alpha = alphas.GetDat(edgeId, InitAlpha);
 
-      alpha -= (alphaGradient + (Regularizer ? Mu : TFlt(0.0)) * alpha);
-
-      if (alpha < Tol) alpha = Tol;
-      if (alpha > MaxAlpha) alpha = MaxAlpha;
-
-      if (!alphas.IsKey(key)) alphas.AddDat(key,alpha);
-      else alphas.GetDat(key) = alpha;
+      alphas.AddDat(edgeId, projectAlpha(alpha, alphaGradient));
    }
    return *this; 
 }
 
+TFlt AdditiveRiskParameter::projectAlpha(TFlt alpha, const TFlt alphaGradient) const {
+   alpha -= (alphaGradient + (Regularizer ? Mu : TFlt(0.0)) * alpha);
+
+   if (alpha < Tol) alpha = Tol;
+   if (alpha > MaxAlpha) alpha = MaxAlpha;
+   return alpha;
+}
+
 void AdditiveRiskParameter::reset() {
    alphas.Clr();
+   moments.Clr();
 }
 
 void AdditiveRiskParameter::set(AdditiveRiskFunctionConfigure configure) {
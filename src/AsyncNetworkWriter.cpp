@@ -0,0 +1,77 @@
+#include <AsyncNetworkWriter.h>
+#include <ResultWriter.h>
+
+AsyncNetworkWriter::AsyncNetworkWriter(TemporalNetwork& inferredNetwork, TemporalNetwork& maxNetwork, const THash<TInt, TNodeInfo>& nodeNmH,
+                                       const TStr& outFNm, const double minAlpha, const double aging, const bool binaryEdges) :
+   InferredNetwork(inferredNetwork), MaxNetwork(maxNetwork), NodeNmH(nodeNmH), OutFNm(outFNm),
+   MinAlpha(minAlpha), Aging(aging), BinaryEdges(binaryEdges), time(0.0), prevTime(0.0), isRunning(false) {}
+
+void AsyncNetworkWriter::AddTopic(const TInt key, const TFlt pi, const EdgeAlphas& alphas, const EdgeIndex& potentialEdges) {
+   TopicSnapshot& topic = pending[pending.Add()];
+   topic.key = key;
+   topic.pi = pi;
+   topic.edges.Gen(alphas.Len());
+   topic.alphas.Gen(alphas.Len());
+   for (int i=0; i<alphas.Len(); i++) {
+      TInt edgeId = alphas.GetId(i);
+      topic.edges[i] = potentialEdges.GetEdge(edgeId);
+      topic.alphas[i] = alphas.GetDat(edgeId);
+   }
+}
+
+// Waits for the previous step, since every step reads the networks as left
+// by the one before it.
+void AsyncNetworkWriter::Write(const double stepTime, const double prevStepTime) {
+   Wait();
+   writing.Clr();
+   writing.Swap(pending);
+   time = stepTime;
+   prevTime = prevStepTime;
+   isRunning = pthread_create(&thread, NULL, Run, this) == 0;
+   if (!isRunning) WriteStep();
+}
+
+void AsyncNetworkWriter::Wait() {
+   if (!isRunning) return;
+   pthread_join(thread, NULL);
+   isRunning = false;
+}
+
+void* AsyncNetworkWriter::Run(void *writer) {
+   static_cast<AsyncNetworkWriter*>(writer)->WriteStep();
+   return NULL;
+}
+
+void AsyncNetworkWriter::WriteStep() {
+   int step = InferredNetwork.AddStep(time), prevStep = InferredNetwork.GetStepIdx(prevTime);
+   int maxStep = MaxNetwork.AddStep(time);
+
+   for (int k=0; k<writing.Len(); k++) {
+      const TopicSnapshot& topic = writing[k];
+
+      ResultWriter writer(OutFNm + TStr("_") + topic.key.GetStr() + ".txt", BinaryEdges);
+      writer.PutNodes(NodeNmH);
+
+      for (int i=0; i<topic.alphas.Len(); i++) {
+         if (i%100000==0) printf("add kAlphas: %d, alphas length: %d, alpha index: %d\n", topic.key(),topic.alphas.Len(),i);
+         TInt srcNId = topic.edges[i].Val1, dstNId = topic.edges[i].Val2;
+
+         TFlt alpha = topic.alphas[i];
+         TInt inferredId = InferredNetwork.GetEdgeId(srcNId, dstNId);
+         if (InferredNetwork.IsDat(prevStep, inferredId) && alpha == InferredNetwork.GetDat(prevStep, inferredId))
+            alpha = alpha * Aging;
+
+         if (alpha <= MinAlpha) continue;
+         if (inferredId == -1) inferredId = InferredNetwork.AddEdge(srcNId, dstNId);
+         TInt maxId = MaxNetwork.AddEdge(srcNId, dstNId);
+
+         writer.PutEdge(srcNId, dstNId, time, alpha);
+
+         if (!InferredNetwork.IsDat(step, inferredId)) InferredNetwork.AddDat(step, inferredId, alpha * topic.pi);
+         else InferredNetwork.GetDat(step, inferredId) += alpha * topic.pi;
+
+         if (!MaxNetwork.IsDat(maxStep, maxId)) MaxNetwork.AddDat(maxStep, maxId, alpha);
+         else if (MaxNetwork.GetDat(maxStep, maxId) < alpha) MaxNetwork.GetDat(maxStep, maxId) = alpha;
+      }
+   }
+}
@@ -0,0 +1,232 @@
+#include <CascadeStore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Binary cascade file: the header, then the sections below in this order,
+// each starting at a multiple of 8 bytes. Names are NUL terminated; hit nodes
+// are indices into the node table and the hits of every cascade are sorted by
+// time, as in the store.
+//    int    nodeIds[nodeNm], nodeVols[nodeNm]
+//    int64  nameOffsets[nodeNm+1]
+//    char   names[nameBytes]
+//    int    cascadeIds[cascadeNm], offsets[cascadeNm+1]
+//    int    hitNodes[hitNm]
+//    double hitTimes[hitNm]
+static const char BinMagic[8] = {'C','A','S','C','B','I','N','\0'};
+static const int BinVersion = 1;
+
+struct CascadeBinHeader {
+   char magic[8];
+   int version, pad;
+   int64 nodeNm, nameBytes, cascadeNm, hitNm;
+};
+
+static int64 AlignBin(const int64 bytes) { return (bytes + 7) & ~(int64)7; }
+
+static void PutPadding(TFOut& FOut, const int64 bytes) {
+   static const char zeros[8] = {0};
+   if (AlignBin(bytes) > bytes) FOut.PutBf(zeros, AlignBin(bytes) - bytes);
+}
+
+static void PutSection(TFOut& FOut, const void *bf, const int64 bytes) {
+   if (bytes > 0) FOut.PutBf(bf, bytes);
+   PutPadding(FOut, bytes);
+}
+
+// Returns the section of n values at the cursor and moves the cursor past it.
+template <class T>
+static T* TakeSection(char*& at, const int64 n) {
+   T *section = reinterpret_cast<T*>(at);
+   at += AlignBin(n * sizeof(T));
+   return section;
+}
+
+void CascadeStore::AddNodes(const THash<TInt, TNodeInfo>& NodeNmH) {
+   for (THash<TInt, TNodeInfo>::TIter NI = NodeNmH.BegI(); NI < NodeNmH.EndI(); NI++) AddNode(NI.GetKey());
+}
+
+int CascadeStore::AddNode(const TInt NId) {
+   int keyId = nodeIdxH.GetKeyId(NId);
+   if (keyId != -1) return nodeIdxH[keyId];
+
+   int node = nodeIds.Len();
+   nodeIds.Add(NId);
+   nodeIdxH.AddDat(NId, node);
+   return node;
+}
+
+// TmNIdV is sorted in place, ties by node id.
+void CascadeStore::AddCascade(const TInt CId, TFltIntPrV& TmNIdV) {
+   TmNIdV.Sort(true);
+   if (offsets.Empty()) offsets.Add(0);
+
+   for (int i=0; i<TmNIdV.Len(); i++) {
+      hitNodes.Add(AddNode(TmNIdV[i].Val2));
+      hitTimes.Add(TmNIdV[i].Val1);
+   }
+   cascadeIds.Add(CId);
+   offsets.Add(hitNodes.Len());
+}
+
+// The hits of a TCascade are already sorted by time and are kept in its order.
+void CascadeStore::AddCascade(const TCascade& Cascade) {
+   if (offsets.Empty()) offsets.Add(0);
+
+   for (THash<TInt, THitInfo>::TIter HI = Cascade.BegI(); HI < Cascade.EndI(); HI++) {
+      hitNodes.Add(AddNode(HI.GetKey()));
+      hitTimes.Add(HI.GetDat().Tm);
+   }
+   cascadeIds.Add(Cascade.CId);
+   offsets.Add(hitNodes.Len());
+}
+
+// Cascade c of the store is the cascade with key id c in CascH.
+void CascadeStore::Pack(const THash<TInt, TCascade>& CascH, const THash<TInt, TNodeInfo>& NodeNmH) {
+   Clr();
+   int hitNm = 0;
+   for (int i=0; i<CascH.Len(); i++) hitNm += CascH[i].Len();
+   cascadeIds.Reserve(CascH.Len());
+   offsets.Reserve(CascH.Len() + 1);
+   hitNodes.Reserve(hitNm);
+   hitTimes.Reserve(hitNm);
+
+   AddNodes(NodeNmH);
+   for (int i=0; i<CascH.Len(); i++) AddCascade(CascH[i]);
+}
+
+void CascadeStore::SaveBin(const TStr& OutFNm, const THash<TInt, TNodeInfo>& NodeNmH) const {
+   CascadeBinHeader header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, BinMagic, sizeof(BinMagic));
+   header.version = BinVersion;
+   header.nodeNm = GetNodes();
+   header.cascadeNm = Len();
+   header.hitNm = GetHitNm();
+
+   TIntV nodeVols(GetNodes());
+   TVec<int64> nameOffsets(GetNodes() + 1);
+   nameOffsets[0] = 0;
+   for (int node=0; node<GetNodes(); node++) {
+      int keyId = NodeNmH.GetKeyId(nodeIds[node]);
+      nodeVols[node] = keyId == -1 ? 0 : NodeNmH[keyId].Vol();
+      nameOffsets[node+1] = nameOffsets[node] + (keyId == -1 ? 0 : NodeNmH[keyId].Name.Len()) + 1;
+   }
+   header.nameBytes = nameOffsets[GetNodes()];
+
+   TFOut FOut(OutFNm);
+   PutSection(FOut, &header, sizeof(header));
+   PutSection(FOut, nodeIds.BegI(), GetNodes() * sizeof(int));
+   PutSection(FOut, nodeVols.BegI(), GetNodes() * sizeof(int));
+   PutSection(FOut, nameOffsets.BegI(), (GetNodes() + 1) * sizeof(int64));
+   for (int node=0; node<GetNodes(); node++) {
+      int keyId = NodeNmH.GetKeyId(nodeIds[node]);
+      const char *name = keyId == -1 ? "" : NodeNmH[keyId].Name.CStr();
+      FOut.PutBf(name, strlen(name) + 1);
+   }
+   PutPadding(FOut, header.nameBytes);
+   PutSection(FOut, cascadeIds.BegI(), Len() * sizeof(int));
+   const int noOffsets = 0;
+   PutSection(FOut, offsets.Empty() ? &noOffsets : (const int*)offsets.BegI(), (Len() + 1) * sizeof(int));
+   PutSection(FOut, hitNodes.BegI(), GetHitNm() * sizeof(int));
+   PutSection(FOut, hitTimes.BegI(), GetHitNm() * sizeof(double));
+}
+
+// The nodes of the file are added to NodeNmH in the order of the node table,
+// so that, as after Pack, node index i is the key id of the node in NodeNmH
+// when NodeNmH starts empty. The hit arrays stay in the mapping.
+void CascadeStore::LoadBin(const TStr& InFNm, THash<TInt, TNodeInfo>& NodeNmH) {
+   Clr();
+
+   int fd = open(InFNm.CStr(), O_RDONLY);
+   EAssertR(fd != -1, TStr::Fmt("Can not open cascades file %s", InFNm.CStr()));
+   struct stat st;
+   EAssertR(fstat(fd, &st) == 0, TStr::Fmt("Can not stat cascades file %s", InFNm.CStr()));
+   EAssertR((size_t)st.st_size >= sizeof(CascadeBinHeader), TStr::Fmt("%s is not a binary cascades file", InFNm.CStr()));
+   mappedLen = st.st_size;
+   mapped = mmap(NULL, mappedLen, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (mapped == MAP_FAILED) { mapped = NULL; mappedLen = 0; }
+   EAssertR(mapped != NULL, TStr::Fmt("Can not map cascades file %s", InFNm.CStr()));
+
+   char *at = static_cast<char*>(mapped);
+   const CascadeBinHeader& header = *TakeSection<CascadeBinHeader>(at, 1);
+   EAssertR(memcmp(header.magic, BinMagic, sizeof(BinMagic)) == 0 && header.version == BinVersion,
+            TStr::Fmt("%s is not a binary cascades file of version %d", InFNm.CStr(), BinVersion));
+   int64 expectedLen = AlignBin(sizeof(CascadeBinHeader)) + 2 * AlignBin(header.nodeNm * sizeof(int)) + AlignBin((header.nodeNm + 1) * sizeof(int64))
+                     + AlignBin(header.nameBytes) + AlignBin(header.cascadeNm * sizeof(int)) + AlignBin((header.cascadeNm + 1) * sizeof(int))
+                     + AlignBin(header.hitNm * sizeof(int)) + AlignBin(header.hitNm * sizeof(double));
+   EAssertR((int64)mappedLen == expectedLen, TStr::Fmt("Truncated cascades file %s", InFNm.CStr()));
+
+   const int *nodeIdsBf = TakeSection<int>(at, header.nodeNm);
+   const int *nodeVols = TakeSection<int>(at, header.nodeNm);
+   const int64 *nameOffsets = TakeSection<int64>(at, header.nodeNm + 1);
+   const char *names = TakeSection<char>(at, header.nameBytes);
+   cascadeIds.GenExt(TakeSection<TInt>(at, header.cascadeNm), header.cascadeNm);
+   offsets.GenExt(TakeSection<TInt>(at, header.cascadeNm + 1), header.cascadeNm + 1);
+   hitNodes.GenExt(TakeSection<TInt>(at, header.hitNm), header.hitNm);
+   hitTimes.GenExt(TakeSection<TFlt>(at, header.hitNm), header.hitNm);
+
+   // the node table is copied, so that AddNode still works on a loaded store
+   nodeIds.Gen(header.nodeNm);
+   nodeIdxH.Gen(header.nodeNm);
+   for (int node=0; node<header.nodeNm; node++) {
+      nodeIds[node] = nodeIdsBf[node];
+      nodeIdxH.AddDat(nodeIds[node], node);
+      int keyId = NodeNmH.GetKeyId(nodeIds[node]);
+      if (keyId == -1) NodeNmH.AddDat(nodeIds[node], TNodeInfo(TStr(names + nameOffsets[node]), nodeVols[node]));
+      else NodeNmH[keyId].Vol += nodeVols[node];
+   }
+}
+
+int CascadeStore::GetLenBeforeT(const int c, const double time) const {
+   int hit = offsets[c];
+   while (hit < offsets[c+1] && hitTimes[hit] <= time) hit++;
+   return hit - offsets[c];
+}
+
+void CascadeStore::Prefetch(const int c) const {
+   int hit = offsets[c];
+   if (hit == offsets[c+1]) return;
+   __builtin_prefetch(&hitNodes[hit]);
+   __builtin_prefetch(&hitTimes[hit]);
+}
+
+int CascadeStore::GetNodeIdx(const TInt NId) const {
+   int keyId = nodeIdxH.GetKeyId(NId);
+   if (keyId == -1) return -1;
+   return nodeIdxH[keyId];
+}
+
+void CascadeStore::Clr() {
+   cascadeIds.Clr();
+   offsets.Clr();
+   hitNodes.Clr();
+   hitTimes.Clr();
+   nodeIds.Clr();
+   nodeIdxH.Clr();
+   if (mapped != NULL) {
+      munmap(mapped, mappedLen);
+      mapped = NULL;
+      mappedLen = 0;
+   }
+}
+
+const double CascadeTimes::NotInfected = TFlt::Mx;
+
+CascadeTimes::CascadeTimes(const CascadeStore& cascadeStore) : store(cascadeStore), cascade(-1) {
+   times.Gen(store.GetNodes());
+   times.PutAll(NotInfected);
+}
+
+void CascadeTimes::Load(const int c) {
+   if (cascade != -1) Unload();
+   for (int hit=store.GetBeg(c); hit<store.GetEnd(c); hit++) times[store.GetNode(hit)] = store.GetTm(hit);
+   cascade = c;
+}
+
+void CascadeTimes::Unload() {
+   for (int hit=store.GetBeg(cascade); hit<store.GetEnd(cascade); hit++) times[store.GetNode(hit)] = NotInfected;
+   cascade = -1;
+}
@@ -0,0 +1,224 @@
+#include <CompiledCascades.h>
+
+// Copy of the hits of one cascade of the store, from which the shaping values
+// towards one destination time are evaluated as a vector. The shaping calls
+// are qualified with TShaping so that they are bound statically instead of
+// going through the vtable.
+class CascadeHits {
+   public:
+      CascadeHits(const CascadeStore& store, const int c) : hitNm(store.GetCascadeLen(c)) {
+         nodes = new int[hitNm];
+         nIds = new int[hitNm];
+         times = new double[hitNm];
+         dts = new double[hitNm];
+         for (int i=0; i<hitNm; i++) {
+            int hit = store.GetBeg(c) + i;
+            nodes[i] = store.GetNode(hit);
+            nIds[i] = store.GetNId(hit);
+            times[i] = store.GetTm(hit);
+         }
+      }
+      ~CascadeHits() {
+         delete[] nodes;
+         delete[] nIds;
+         delete[] times;
+         delete[] dts;
+      }
+
+      // Fills values/integrals for the hits that are Before dstTime, which
+      // form a prefix of the cascade, and returns their number.
+      template <class TShaping>
+      int Shape(const TShaping& shapingFunction, const double dstTime, double *values, double *integrals) {
+         int n = 0;
+         while (n < hitNm && shapingFunction.TShaping::Before(times[n], dstTime)) n++;
+         BatchTimeDiffs(times, dstTime, dts, n);
+         if (values != NULL) shapingFunction.TShaping::ValueV(dts, values, n);
+         shapingFunction.TShaping::IntegralV(dts, integrals, n);
+         return n;
+      }
+
+      int Len() const { return hitNm; }
+      int GetNode(const int i) const { return nodes[i]; }
+      int GetNId(const int i) const { return nIds[i]; }
+      double GetTm(const int i) const { return times[i]; }
+
+   private:
+      int hitNm;
+      int *nodes, *nIds;
+      double *times, *dts;
+};
+
+template <class TShaping>
+void CompiledCascade::Compile(const CascadeStore& store, const int c, const CascadeTimes& times, const int nodeNm, const EdgeIndex& potentialEdges,
+                              const TShaping& shapingFunction, const double CurrentTime, const double observedWindow) {
+   Clr();
+   offsets.Add(0);
+
+   CascadeHits hits(store, c);
+   double *values = new double[hits.Len()];
+   double *integrals = new double[hits.Len()];
+   double *survivalIntegrals = new double[hits.Len()];
+   int survivalNm = hits.Shape(shapingFunction, store.GetMaxTm(c) + observedWindow, NULL, survivalIntegrals);
+
+   for (int node=0; node<nodeNm; node++) {
+      TInt dstNId = store.GetNodeNId(node);
+      bool isInfected = times.IsNode(node) && times.GetTm(node) <= CurrentTime;
+
+      if (isInfected) {
+         int parentNm = hits.Shape(shapingFunction, times.GetTm(node), values, integrals);
+         for (int j=0; j<parentNm; j++) {
+            ParentEntry parent;
+            parent.edgeId = potentialEdges.GetEdgeId(hits.GetNId(j), dstNId);
+            parent.position = j;
+            parent.value = values[j];
+            parent.integral = integrals[j];
+            parents.Add(parent);
+         }
+      }
+      else {
+         for (int j=0; j<survivalNm; j++) {
+            TInt edgeId = potentialEdges.GetEdgeId(hits.GetNId(j), dstNId);
+            if (edgeId == -1) continue;
+
+            ParentEntry parent;
+            parent.edgeId = edgeId;
+            parent.position = j;
+            parent.value = 0.0;
+            parent.integral = survivalIntegrals[j];
+            parents.Add(parent);
+         }
+      }
+
+      AddDst(dstNId, isInfected);
+   }
+
+   delete[] values;
+   delete[] integrals;
+   delete[] survivalIntegrals;
+}
+
+template <class TShaping>
+void CompiledCascade::CompileSparse(const CascadeStore& store, const int c, const CascadeTimes& times, const int nodeNm, const EdgeIndex& potentialEdges,
+                                    const TIntV& edgeDstNodes, const TShaping& shapingFunction, const double CurrentTime, const double observedWindow) {
+   Clr();
+   offsets.Add(0);
+
+   CascadeHits hits(store, c);
+   double *values = new double[hits.Len()];
+   double *integrals = new double[hits.Len()];
+
+   for (int i=0; i<hits.Len(); i++) {
+      double dstTime = hits.GetTm(i);
+      if (dstTime > CurrentTime || hits.GetNode(i) >= nodeNm) continue;
+
+      TInt dstNId = hits.GetNId(i);
+      int parentNm = hits.Shape(shapingFunction, dstTime, values, integrals);
+      for (int j=0; j<parentNm; j++) {
+         ParentEntry parent;
+         parent.edgeId = potentialEdges.GetEdgeId(hits.GetNId(j), dstNId);
+         parent.position = j;
+         parent.value = values[j];
+         parent.integral = integrals[j];
+         parents.Add(parent);
+      }
+
+      AddDst(dstNId, true);
+   }
+
+   THash<TInt, TVec<ParentEntry> > survivalParents;
+   int survivalNm = hits.Shape(shapingFunction, store.GetMaxTm(c) + observedWindow, NULL, integrals);
+
+   for (int j=0; j<survivalNm; j++) {
+      TInt srcNId = hits.GetNId(j);
+      if (potentialEdges.GetOutDeg(srcNId) == 0) continue;
+
+      ParentEntry parent;
+      parent.position = j;
+      parent.value = 0.0;
+      parent.integral = integrals[j];
+
+      const TIntV& outEdgeIds = potentialEdges.GetOutEdgeIds(srcNId);
+      for (int k=0; k<outEdgeIds.Len(); k++) {
+         int dstNode = edgeDstNodes[outEdgeIds[k]];
+         if (dstNode == -1 || dstNode >= nodeNm) continue;
+         if (times.IsNode(dstNode) && times.GetTm(dstNode) <= CurrentTime) continue;
+
+         parent.edgeId = outEdgeIds[k];
+         survivalParents.AddDat(store.GetNodeNId(dstNode)).Add(parent);
+      }
+   }
+
+   for (THash<TInt, TVec<ParentEntry> >::TIter DI = survivalParents.BegI(); !DI.IsEnd(); DI++) {
+      parents.AddV(DI.GetDat());
+      AddDst(DI.GetKey(), false);
+   }
+
+   delete[] values;
+   delete[] integrals;
+}
+
+void CompiledCascade::AddDst(const TInt dstNId, const bool isInfected) {
+   if (parents.Len() == offsets.Last()) return;
+   dstNIds.Add(dstNId);
+   infected.Add(isInfected);
+   offsets.Add(parents.Len());
+}
+
+void CompiledCascade::Clr() {
+   dstNIds.Clr();
+   infected.Clr();
+   offsets.Clr();
+   parents.Clr();
+}
+
+void CompiledCascade::Prefetch() const {
+   if (dstNIds.Empty()) return;
+   __builtin_prefetch(&dstNIds[0]);
+   __builtin_prefetch(&infected[0]);
+   __builtin_prefetch(&offsets[0]);
+   if (parents.Empty()) return;
+   // the first few lines of parents; the hardware prefetcher takes the rest
+   const char *first = (const char *)&parents[0];
+   const int bytes = TMath::Mn(parents.Len() * (int)sizeof(ParentEntry), 4 * 64);
+   for (int b=0; b<bytes; b+=64) __builtin_prefetch(first + b);
+}
+
+void CompiledCascades::Compile(Data data, const EdgeIndex& potentialEdges, const TimeShapingFunction *shapingFunction, const double observedWindow, const bool sparseSurvival) {
+   switch (shapingFunction->GetModel()) {
+      case POW :
+         CompileModel(data, potentialEdges, *static_cast<const POWShapingFunction*>(shapingFunction), observedWindow, sparseSurvival);
+         break;
+      case RAY :
+         CompileModel(data, potentialEdges, *static_cast<const RAYShapingFunction*>(shapingFunction), observedWindow, sparseSurvival);
+         break;
+      default :
+         CompileModel(data, potentialEdges, *static_cast<const EXPShapingFunction*>(shapingFunction), observedWindow, sparseSurvival);
+   }
+}
+
+template <class TShaping>
+void CompiledCascades::CompileModel(Data data, const EdgeIndex& potentialEdges, const TShaping& shapingFunction, const double observedWindow, const bool sparseSurvival) {
+   const CascadeStore& store = data.cascades;
+   int cascadesNum = store.Len();
+   int nodeNm = data.NodeNmH.Len();
+   IAssert(nodeNm <= store.GetNodes());
+   cascades.Clr();
+   cascades.Gen(cascadesNum);
+
+   TIntV edgeDstNodes;
+   if (sparseSurvival) {
+      edgeDstNodes.Gen(potentialEdges.Len());
+      for (int i=0; i<potentialEdges.Len(); i++) edgeDstNodes[i] = store.GetNodeIdx(potentialEdges.GetEdge(i).Val2);
+   }
+
+   #pragma omp parallel
+   {
+      CascadeTimes times(store);
+      #pragma omp for schedule(dynamic)
+      for (int i=0; i<cascadesNum; i++) {
+         times.Load(i);
+         if (sparseSurvival) cascades[i].CompileSparse(store, i, times, nodeNm, potentialEdges, edgeDstNodes, shapingFunction, data.time, observedWindow);
+         else cascades[i].Compile(store, i, times, nodeNm, potentialEdges, shapingFunction, data.time, observedWindow);
+      }
+   }
+}
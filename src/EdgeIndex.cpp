@@ -0,0 +1,211 @@
+#include <EdgeIndex.h>
+
+TInt EdgeIndex::AddEdge(const TInt srcNId, const TInt dstNId) {
+   TIntPr key(srcNId, dstNId);
+   int keyId = edgeIds.GetKeyId(key);
+   if (keyId != -1) return edgeIds[keyId];
+
+   TInt edgeId = edges.Len();
+   edges.Add(key);
+   edgeIds.AddDat(key, edgeId);
+   outEdgeIds.AddDat(srcNId).Add(edgeId);
+   return edgeId;
+}
+
+TInt EdgeIndex::GetEdgeId(const TInt srcNId, const TInt dstNId) const {
+   int keyId = edgeIds.GetKeyId(TIntPr(srcNId, dstNId));
+   if (keyId == -1) return -1;
+   return edgeIds[keyId];
+}
+
+void EdgeIndex::Clr() {
+   edgeIds.Clr();
+   edges.Clr();
+   outEdgeIds.Clr();
+}
+
+// LSD radix sort of keys, carrying times along, 16 bits per pass. Passes in
+// which every key has the same digit are skipped.
+static void RadixSortPairs(uint64 *keys, double *times, const int64 n) {
+   const int digitNm = 1 << 16;
+   uint64 *keyBuf = new uint64[n];
+   double *timeBuf = new double[n];
+   int64 *counts = new int64[digitNm];
+
+   for (int shift = 0; shift < 64; shift += 16) {
+      for (int d = 0; d < digitNm; d++) counts[d] = 0;
+      for (int64 i = 0; i < n; i++) counts[(keys[i] >> shift) & (digitNm - 1)]++;
+      if (n == 0 || counts[(keys[0] >> shift) & (digitNm - 1)] == n) continue;
+
+      int64 offset = 0;
+      for (int d = 0; d < digitNm; d++) {
+         int64 count = counts[d];
+         counts[d] = offset;
+         offset += count;
+      }
+      for (int64 i = 0; i < n; i++) {
+         int64 position = counts[(keys[i] >> shift) & (digitNm - 1)]++;
+         keyBuf[position] = keys[i];
+         timeBuf[position] = times[i];
+      }
+      for (int64 i = 0; i < n; i++) {
+         keys[i] = keyBuf[i];
+         times[i] = timeBuf[i];
+      }
+   }
+
+   delete[] keyBuf;
+   delete[] timeBuf;
+   delete[] counts;
+}
+
+// The pairs are generated in parallel, each cascade into its own slice of a
+// flat buffer, as (srcNode << 32 | dstNode, dst time). Radix sorting the
+// buffer makes the occurrences of a pair adjacent, and they are merged into
+// one entry with the earliest time; pairs found in fewer than minCoOccurrence
+// cascades are dropped. A node occurs at most once per cascade, so the number
+// of occurrences is the number of cascades. To bound the memory, the source
+// nodes are split into ranges of at most PairBudget pairs, handled one at a
+// time.
+void EdgeSchedule::Build(const CascadeStore& cascades, const int minCoOccurrence) {
+   Clr();
+   int nodeNm = cascades.GetNodes();
+   int cascadesNum = cascades.Len();
+
+   int64 *srcPairNms = new int64[nodeNm];
+   for (int node = 0; node < nodeNm; node++) srcPairNms[node] = 0;
+   for (int c = 0; c < cascadesNum; c++) {
+      for (int i = cascades.GetBeg(c); i < cascades.GetEnd(c); i++) srcPairNms[cascades.GetNode(i)] += cascades.GetEnd(c) - 1 - i;
+   }
+
+   TFltV activationTimes;
+   int64 *offsets = new int64[cascadesNum + 1];
+   int lo = 0;
+   while (lo < nodeNm) {
+      int hi = lo;
+      int64 pairNm = 0;
+      while (hi < nodeNm && (hi == lo || pairNm + srcPairNms[hi] <= PairBudget)) pairNm += srcPairNms[hi++];
+
+      offsets[0] = 0;
+      for (int c = 0; c < cascadesNum; c++) {
+         int64 cascadePairNm = 0;
+         for (int i = cascades.GetBeg(c); i < cascades.GetEnd(c); i++) {
+            int node = cascades.GetNode(i);
+            if (node >= lo && node < hi) cascadePairNm += cascades.GetEnd(c) - 1 - i;
+         }
+         offsets[c + 1] = offsets[c] + cascadePairNm;
+      }
+
+      uint64 *keys = new uint64[pairNm];
+      double *times = new double[pairNm];
+
+      #pragma omp parallel for schedule(dynamic, 64)
+      for (int c = 0; c < cascadesNum; c++) {
+         int64 position = offsets[c];
+         for (int i = cascades.GetBeg(c); i < cascades.GetEnd(c); i++) {
+            int node = cascades.GetNode(i);
+            if (node < lo || node >= hi) continue;
+            for (int j = i + 1; j < cascades.GetEnd(c); j++, position++) {
+               keys[position] = ((uint64) node << 32) | (uint64) cascades.GetNode(j);
+               times[position] = cascades.GetTm(j);
+            }
+         }
+      }
+
+      RadixSortPairs(keys, times, pairNm);
+
+      for (int64 i = 0; i < pairNm; ) {
+         int64 j = i;
+         double activationTime = times[i];
+         for (; j < pairNm && keys[j] == keys[i]; j++) {
+            if (times[j] < activationTime) activationTime = times[j];
+         }
+         if (j - i >= minCoOccurrence) {
+            pairs.Add(TIntPr(cascades.GetNodeNId(int(keys[i] >> 32)), cascades.GetNodeNId(int(keys[i] & 0xffffffff))));
+            activationTimes.Add(activationTime);
+         }
+         i = j;
+      }
+
+      delete[] keys;
+      delete[] times;
+      lo = hi;
+   }
+   delete[] offsets;
+   delete[] srcPairNms;
+
+   activations.Gen(pairs.Len(), 0);
+   for (int i=0; i<pairs.Len(); i++) activations.Add(TFltIntPr(activationTimes[i], i));
+   activations.Sort(true);
+   built = true;
+}
+
+// Returns the number of pairs activated by this call.
+int EdgeSchedule::Activate(const double time, EdgeIndex& potentialEdges) {
+   int first = next;
+   while (next < activations.Len() && activations[next].Val1 <= time) {
+      const TIntPr& pair = pairs[activations[next].Val2];
+      potentialEdges.AddEdge(pair.Val1, pair.Val2);
+      next++;
+   }
+   return next - first;
+}
+
+void EdgeSchedule::Clr() {
+   built = false;
+   next = 0;
+   pairs.Clr();
+   activations.Clr();
+}
+
+EdgeAlphas& EdgeAlphas::operator += (const EdgeAlphas& p) {
+   for (int i=0; i<p.ids.Len(); i++) {
+      TInt edgeId = p.ids[i];
+      if (!IsKey(edgeId)) AddDat(edgeId, p.values[edgeId]);
+      else values[edgeId] += p.values[edgeId];
+   }
+   return *this;
+}
+
+EdgeAlphas& EdgeAlphas::operator *= (const TFlt multiplier) {
+   for (int i=0; i<ids.Len(); i++) values[ids[i]] *= multiplier;
+   return *this;
+}
+
+TFlt& EdgeAlphas::AddDat(const TInt edgeId, const TFlt value) {
+   if (edgeId >= values.Len()) Resize(edgeId + 1);
+   if (!isSet[edgeId]) {
+      isSet[edgeId] = true;
+      ids.Add(edgeId);
+   }
+   values[edgeId] = value;
+   return values[edgeId];
+}
+
+void EdgeAlphas::Resize(const int edgeNm) {
+   if (edgeNm <= values.Len()) return;
+   if (edgeNm > values.Reserved()) {
+      int mxVals = 2 * values.Reserved() > edgeNm ? 2 * values.Reserved() : edgeNm;
+      values.Reserve(mxVals);
+      isSet.Reserve(mxVals);
+   }
+   while (values.Len() < edgeNm) {
+      values.Add(0.0);
+      isSet.Add(false);
+   }
+}
+
+// Assigns value to every id below edgeNm that has none yet, so that later
+// writes to those ids never grow the storage.
+void EdgeAlphas::Fill(const int edgeNm, const TFlt value) {
+   Resize(edgeNm);
+   ids.Reserve(edgeNm);
+   for (int edgeId=0; edgeId<edgeNm; edgeId++) {
+      if (!isSet[edgeId]) AddDat(edgeId, value);
+   }
+}
+
+void EdgeAlphas::Clr() {
+   for (int i=0; i<ids.Len(); i++) isSet[ids[i]] = false;
+   ids.Clr(false);
+}
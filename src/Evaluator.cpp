@@ -8,16 +8,17 @@ void Evaluator::LoadGroundTruth(TSIn &SIn) {
 
 void Evaluator::LoadInferredNetwork(TSIn &SIn, TStr modelName) {
    NodeInfo nodeInfo;
-   InferredNetworks.Add(TStrFltFltHNEDNet());
-   ModelNames.Add(modelName);
-   TStrFltFltHNEDNet &inferredNetwork = InferredNetworks.Last();
+   TStrFltFltHNEDNet inferredNetwork;
    InfoPathFileIO::LoadNetworkTxt(SIn, inferredNetwork, nodeInfo);
+   ModelNames.Add(modelName);
+   InferredNetworks.Add();
+   InferredNetworks.Last().FromNetwork(inferredNetwork);
 }
 
 void Evaluator::EvaluatePRC(const TFlt &step, bool verbol) {
 
    for (int i=0;i<InferredNetworks.Len();i++) {
-      TFlt inferredStep = GetInferredTimeStep(step, i);
+      int inferredStep = InferredNetworks[i].GetStepIdx(GetInferredTimeStep(step, i));
       PRC.Add(DyPRCPoints());
       DyPRCPoints &dyPRCPoints = PRC[i];
       if (dyPRCPoints.IsKey(step)) continue;
@@ -27,7 +28,7 @@ void Evaluator::EvaluatePRC(const TFlt &step, bool verbol) {
 
       if (verbol) printf("Evluating PRC points, model:%s\n",ModelNames[i]());
 
-      TStrFltFltHNEDNet &inferredNetwork = InferredNetworks[i];
+      const TemporalNetwork &inferredNetwork = InferredNetworks[i];
       TFlt nodeSize = (TFlt)GroundTruth.GetNodes();
       TFlt P = (TFlt)GroundTruth.GetEdges(), N = nodeSize * (nodeSize - 1.0) - P;
       TFlt TP = 0.0, FP = 0.0, FN = 0.0;
@@ -39,11 +40,11 @@ void Evaluator::EvaluatePRC(const TFlt &step, bool verbol) {
       endPoint.Val1 = 1.0; endPoint.Val2 = P / (P + N);
       prcPoints.Add(endPoint);
 
-      for (TStrFltFltHNEDNet::TEdgeI EI = inferredNetwork.BegEI(); EI < inferredNetwork.EndEI(); EI++) {
-         TInt srcNId = EI.GetSrcNId(), dstNId = EI.GetDstNId();
-         TIntPr index; index.Val1 = srcNId; index.Val2 = dstNId;
+      for (int e=0; e<inferredNetwork.GetEdges(); e++) {
+         const TIntPr& index = inferredNetwork.GetEdge(e);
+         TInt srcNId = index.Val1, dstNId = index.Val2;
          
-         edgesAlphaVector.AddDat(index, EI.GetDat().GetDat(inferredStep));
+         edgesAlphaVector.AddDat(index, inferredNetwork.GetDat(inferredStep, e));
          if (GroundTruth.IsEdge(srcNId,dstNId)) { 
             edgesTruthTable.AddDat(index,true);
             TP++;
@@ -124,15 +125,15 @@ void Evaluator::EvaluateMSE(const TFlt &step) {
      MSE.Add(TFltFltH()); MAE.Add(TFltFltH());
      TFlt mse = 0.0;
      TFlt mae = 0.0;
-     TStrFltFltHNEDNet &inferredNetwork = InferredNetworks[i];
-     TFlt inferredStep = GetInferredTimeStep(step, i);
+     const TemporalNetwork &inferredNetwork = InferredNetworks[i];
+     int inferredStep = inferredNetwork.GetStepIdx(GetInferredTimeStep(step, i));
 
-     for (TStrFltFltHNEDNet::TEdgeI EI = inferredNetwork.BegEI();EI!=inferredNetwork.EndEI();EI++) {
-        int srcNId = EI.GetSrcNId();
-        int dstNId = EI.GetDstNId();
+     for (int e=0; e<inferredNetwork.GetEdges(); e++) {
+        int srcNId = inferredNetwork.GetEdge(e).Val1;
+        int dstNId = inferredNetwork.GetEdge(e).Val2;
         if (srcNId==dstNId) continue;
         
-        TFlt inferredAlpha = EI.GetDat().GetDat(inferredStep);
+        TFlt inferredAlpha = inferredNetwork.GetDat(inferredStep, e);
         
         if (GroundTruth.IsEdge(srcNId,dstNId)) {
            TFlt groundTruthAlpha = GroundTruth.GetEDat(srcNId,dstNId).GetDat(groundTruthStep);
@@ -214,11 +215,9 @@ void Evaluator::PlotMSE(const TStr &OutFNm) const {
    }
 }
 
-TVec<TFlt> Evaluator::GetSteps(size_t i) const {
+const TFltV& Evaluator::GetSteps(size_t i) const {
    IAssert(i < (size_t)InferredNetworks.Len());
-   TVec<TFlt> steps;
-   InferredNetworks[i].BegEI().GetDat().GetKeyV(steps);
-   return steps;
+   return InferredNetworks[i].GetStepV();
 }
 
 TFlt Evaluator::GetGroundTruthTimeStep(TFlt step) const {
@@ -239,7 +238,7 @@ TFlt Evaluator::GetGroundTruthTimeStep(TFlt step) const {
 }
 
 TFlt Evaluator::GetInferredTimeStep(TFlt step, size_t i) const {
-   TVec<TFlt> steps = GetSteps(i);
+   const TFltV& steps = GetSteps(i);
    TFlt InferredTimeStep = steps[0];
 
    for (int t=1;t<steps.Len();t++) {
@@ -1,56 +1,100 @@
 #include <FASTENFunction.h>
 
 TFlt FASTENFunction::JointLikelihood(Datum datum, TInt latentVariable) const {
-   double CurrentTime = datum.time;
-   TCascade &Cascade = datum.cascH.GetDat(datum.index);
-   THash<TInt, TNodeInfo> &NodeNmH = datum.NodeNmH;
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
    double totalLoss = 0.0;
 
-   int nodeSize = NodeNmH.Len();
+   int dstSize = Cascade.Len();
+   double *sumInLogs = new double[dstSize];
    #pragma omp parallel for reduction(+:totalLoss)
-   for (int i=0;i<nodeSize;i++) {
-      TInt key = NodeNmH.GetKey(i);
-      TInt dstNId = key, srcNId;
-      TFlt sumInLog = 0.0, val = 0.0;
-      TFlt dstTime, srcTime;
-      double lossValue;
-
-      if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime) dstTime = Cascade.GetTm(dstNId);
-      else dstTime = Cascade.GetMaxTm() + observedWindow;
-
-      TFlt nodePosition = 0.0;
-      for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++, nodePosition++) {
-         srcNId = CascadeNI.GetKey();
-         srcTime = CascadeNI.GetDat().Tm;
-
-         if (!shapingFunction->Before(srcTime,dstTime)) break; 
-                        
-         TFlt alpha = 0.0;
-         TIntPr key(srcNId, dstNId);
-         if (potentialEdges.IsKey(key))
-            alpha = GetTopicAlpha(srcNId, dstNId, latentVariable) / TMath::Power(decayRatio, nodePosition);
-
-         sumInLog += alpha * shapingFunction->Value(srcTime,dstTime);
-         val += alpha * shapingFunction->Integral(srcTime,dstTime);
-         //printf("sumInLog:%f,val:%f, alpha:%f, shapingVal:%f, shapingInt:%f\n",sumInLog(),val(),alpha(),shapingFunction->Value(srcTime,dstTime)(),shapingFunction->Integral(srcTime,dstTime)()); 
+   for (int i=0;i<dstSize;i++) {
+      double sumInLog = 0.0, val = 0.0;
+
+      for (int j=Cascade.GetBeg(i);j<Cascade.GetEnd(i);j++) {
+         const ParentEntry &parent = Cascade.GetParent(j);
+         if (parent.edgeId == -1) continue;
+
+         double alpha = parameter.GetTopicAlpha(parent.edgeId, latentVariable) / decayPowers[parent.position];
+         sumInLog += alpha * parent.value;
+         val += alpha * parent.integral;
       }
-      lossValue = val;
-      
-      if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime && sumInLog!=0.0) lossValue -= TMath::Log(sumInLog);
-      totalLoss += lossValue;
+
+      sumInLogs[i] = (Cascade.IsInfected(i) && sumInLog!=0.0) ? sumInLog : 1.0;
+      totalLoss += val;
    }
+   totalLoss -= BatchLogSum(sumInLogs, dstSize);
+   delete[] sumInLogs;
 
    TFlt logPi = TMath::Log(parameter.priorTopicProbability.GetDat(latentVariable));
    //printf("datum:%d, Myloss:%f, logPi:%f\n",datum.index(), totalLoss, logPi());
    return logPi - totalLoss;
 }
 
-FASTENParameter& FASTENFunction::gradient(Datum datum) {
-   double CurrentTime = datum.time;
-   TCascade &Cascade = datum.cascH.GetDat(datum.index);
-   THash<TInt, TNodeInfo> &NodeNmH = datum.NodeNmH;
- 
-   parameterGrad.reset();
+// All topics in one sweep over the compiled cascade; the inner loops run over
+// the topics of one parent entry.
+void FASTENFunction::JointLikelihoodAllTopics(Datum datum, double *jointLikelihoods) const {
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
+
+   int latentVariableSize = parameter.latentVariableSize;
+   const EdgeAlphas **topicAlphas = new const EdgeAlphas*[latentVariableSize];
+   double *totalLosses = new double[latentVariableSize];
+   for (int k = 0; k < latentVariableSize; k++) {
+      topicAlphas[k] = &parameter.kAlphas.GetDat(k);
+      totalLosses[k] = 0.0;
+   }
+
+   int dstSize = Cascade.Len();
+   // sumInLogs[k * dstSize + i]
+   double *sumInLogs = new double[latentVariableSize * dstSize];
+
+   #pragma omp parallel
+   {
+      double *sumInLog = new double[latentVariableSize];
+      double *val = new double[latentVariableSize];
+      double *losses = new double[latentVariableSize];
+      for (int k = 0; k < latentVariableSize; k++) losses[k] = 0.0;
+
+      #pragma omp for
+      for (int i=0;i<dstSize;i++) {
+         for (int k = 0; k < latentVariableSize; k++) sumInLog[k] = val[k] = 0.0;
+
+         for (int j=Cascade.GetBeg(i);j<Cascade.GetEnd(i);j++) {
+            const ParentEntry &parent = Cascade.GetParent(j);
+            if (parent.edgeId == -1) continue;
+            double decay = decayPowers[parent.position];
+
+            for (int k = 0; k < latentVariableSize; k++) {
+               double alpha = topicAlphas[k]->GetDat(parent.edgeId, parameter.InitAlpha) / decay;
+               sumInLog[k] += alpha * parent.value;
+               val[k] += alpha * parent.integral;
+            }
+         }
+
+         for (int k = 0; k < latentVariableSize; k++) {
+            sumInLogs[k * dstSize + i] = (Cascade.IsInfected(i) && sumInLog[k]!=0.0) ? sumInLog[k] : 1.0;
+            losses[k] += val[k];
+         }
+      }
+
+      #pragma omp critical
+      for (int k = 0; k < latentVariableSize; k++) totalLosses[k] += losses[k];
+
+      delete[] sumInLog;
+      delete[] val;
+      delete[] losses;
+   }
+
+   for (int k = 0; k < latentVariableSize; k++) {
+      double totalLoss = totalLosses[k] - BatchLogSum(sumInLogs + k * dstSize, dstSize);
+      jointLikelihoods[k] = TMath::Log(parameter.priorTopicProbability.GetDat(k)) - totalLoss;
+   }
+
+   delete[] topicAlphas;
+   delete[] totalLosses;
+   delete[] sumInLogs;
+}
+
+void FASTENFunction::accumulateStatistics(Datum datum) {
    if (parameterGrad.priorTopicProbability.Empty()) {
       parameterGrad.sampledTimes = 0;;
       for (TInt i = 0; i < parameter.latentVariableSize; i++) {
@@ -59,80 +103,117 @@ FASTENParameter& FASTENFunction::gradient(Datum datum) {
    }
 
    for (TInt i = 0; i < parameter.latentVariableSize; i++) {
-      parameterGrad.kAlphas.AddDat(i, THash<TIntPr, TFlt>());
-      parameterGrad.priorTopicProbability.GetDat(i) += latentDistributions.GetDat(datum.index).GetDat(i);
+      parameterGrad.priorTopicProbability.GetDat(i) += GetLatentProbability(datum, i);
    }
    parameterGrad.sampledTimes++;
+}
 
-   int nodeSize = NodeNmH.Len();
-   #pragma omp parallel for
-   for (int i=0; i<nodeSize; i++) {
-      TInt dstNId = NodeNmH.GetKey(i), srcNId;
-      TFlt dstTime, srcTime;
-      THash<TInt,TFlt> dstAlphas;
-
-      for (TInt i = 0; i < parameter.latentVariableSize; i++) dstAlphas.AddDat(i, 0.0);
-
-      if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime) {
-         dstTime = Cascade.GetTm(dstNId);
-         TFlt nodePosition = 0.0;
-         for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++, nodePosition++) {
-            srcNId = CascadeNI.GetKey();
-            srcTime = CascadeNI.GetDat().Tm;
-
-            if (!shapingFunction->Before(srcTime,dstTime)) break; 
-                         
-            for (TInt i = 0; i < parameter.latentVariableSize; i++) {
-               TFlt alpha = parameter.GetTopicAlpha(srcNId, dstNId, i) / TMath::Power(decayRatio, nodePosition);
-               dstAlphas.GetDat(i) += alpha * shapingFunction->Value(srcTime,dstTime);
-               //printf("sumInLog:%f, alpha:%f, val:%f, initAlpha:%f\n",sumInLog(),alpha(),shapingFunction->Value(srcTime,dstTime)(),parameter.InitAlpha());
+void FASTENFunction::gradient(Datum datum, FASTENParameter& grad) const {
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
+ 
+   grad.reset();
+   for (TInt i = 0; i < parameter.latentVariableSize; i++) grad.kAlphas.AddDat(i);
+
+   int latentVariableSize = parameter.latentVariableSize;
+   int dstSize = Cascade.Len();
+   int parentSize = Cascade.GetParentNm();
+   const EdgeAlphas **topicAlphas = new const EdgeAlphas*[latentVariableSize];
+   double *latentProbabilities = new double[latentVariableSize];
+   for (int k = 0; k < latentVariableSize; k++) {
+      topicAlphas[k] = &parameter.kAlphas.GetDat(k);
+      latentProbabilities[k] = GetLatentProbability(datum, k);
+   }
+
+   // vals[k * parentSize + j] is the gradient of parent entry j in topic k,
+   // so every entry has its own slot and each topic is contiguous.
+   double *vals = new double[parentSize * latentVariableSize];
+
+   #pragma omp parallel
+   {
+      double *dstAlphas = new double[latentVariableSize];
+
+      #pragma omp for
+      for (int i=0; i<dstSize; i++) {
+         int beg = Cascade.GetBeg(i), end = Cascade.GetEnd(i);
+         bool isInfected = Cascade.IsInfected(i);
+
+         if (isInfected) {
+            for (int k = 0; k < latentVariableSize; k++) dstAlphas[k] = 0.0;
+            for (int j=beg; j<end; j++) {
+               const ParentEntry &parent = Cascade.GetParent(j);
+               double decay = decayPowers[parent.position];
+               for (int k = 0; k < latentVariableSize; k++) {
+                  dstAlphas[k] += topicAlphas[k]->GetDat(parent.edgeId, parameter.InitAlpha) / decay * parent.value;
+               }
             }
          }
-      }
-      else dstTime = Cascade.GetMaxTm() + observedWindow;
-   
-      THash<TInt, THash<TIntPr, TFlt> > kAlphasGradient;
-      for (TInt i = 0; i < parameter.latentVariableSize; i++) {
-         kAlphasGradient.AddDat(i, THash<TIntPr, TFlt>());
-      }
 
-      TFlt nodePosition = 0.0;
-      for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++, nodePosition++) {
-         srcNId = CascadeNI.GetKey();
-         srcTime = CascadeNI.GetDat().Tm;
-   
-         if (!shapingFunction->Before(srcTime,dstTime)) break; 
-         TIntPr key(srcNId, dstNId);
-         if (!potentialEdges.IsKey(key)) continue;
-                           
-         TIntPr alphaIndex; alphaIndex.Val1 = srcNId; alphaIndex.Val2 = dstNId;
-         TFlt val = 0.0;
-
-         for (TInt i = 0; i < parameter.latentVariableSize; i++) {
-            if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime)
-               val = (shapingFunction->Integral(srcTime,dstTime) - shapingFunction->Value(srcTime,dstTime) / dstAlphas.GetDat(i)) / TMath::Power(decayRatio, nodePosition);
-            else
-               val = shapingFunction->Integral(srcTime,dstTime) / TMath::Power(decayRatio, nodePosition);
-            THash<TIntPr, TFlt>& alphaGradient = kAlphasGradient.GetDat(i);
-            alphaGradient.AddDat(alphaIndex, val * latentDistributions.GetDat(datum.index).GetDat(i));
+         for (int j=beg; j<end; j++) {
+            const ParentEntry &parent = Cascade.GetParent(j);
+            if (parent.edgeId == -1) continue;
+            double decay = decayPowers[parent.position];
+
+            for (int k = 0; k < latentVariableSize; k++) {
+               double val;
+               if (isInfected)
+                  val = (parent.integral - parent.value / dstAlphas[k]) / decay;
+               else
+                  val = parent.integral / decay;
+               vals[k * parentSize + j] = val * latentProbabilities[k];
+            }
          }
-         //printf("index:%d, %d,%d: gradient:%f, shapingVal:%f, sumInLog:%f\n",datum.index(),srcNId(),dstNId(),val(),shapingFunction->Integral(srcTime,dstTime)(),sumInLog()); 
       }
 
-      #pragma omp critical 
-      {
-         for (TInt i = 0; i < parameter.latentVariableSize; i++) {
-            THash<TIntPr, TFlt>& alphaGradient = kAlphasGradient.GetDat(i);
-            THash<TIntPr, TFlt>& alpha = parameterGrad.kAlphas.GetDat(i);
-            for (THash<TIntPr, TFlt>::TIter AI = alphaGradient.BegI(); !AI.IsEnd(); AI++) {
-               if (alpha.IsKey(AI.GetKey())) alpha.GetDat(AI.GetKey()) += AI.GetDat();
-               else alpha.AddDat(AI.GetKey(), AI.GetDat());
-            }
-         }
+      delete[] dstAlphas;
+   }
+
+   // The edges of every topic are set in the order of the parent entries,
+   // as a serial scatter would set them. The sums are then taken in
+   // parallel over (topic, shard of edge ids) pairs, with the entries of a
+   // shard in parent order, so no two threads add to the same edge and the
+   // sums come out as in the serial scatter.
+   EdgeAlphas& firstAlpha = grad.kAlphas.GetDat(0);
+   int edgeNm = 0;
+   for (int j = 0; j < parentSize; j++) {
+      int edgeId = Cascade.GetParent(j).edgeId;
+      if (edgeId == -1 || firstAlpha.IsKey(edgeId)) continue;
+      firstAlpha.AddDat(edgeId, 0.0);
+      edgeNm = TMath::Mx(edgeNm, edgeId + 1);
+   }
+   for (int k = 1; k < latentVariableSize; k++) grad.kAlphas.GetDat(k) = firstAlpha;
+
+   int shardNm = TMath::Mx(1, TMath::Mn(4 * omp_get_max_threads(), edgeNm));
+   int *shardOffsets = new int[shardNm + 1];
+   int *shardEntries = new int[parentSize];
+   for (int s = 0; s <= shardNm; s++) shardOffsets[s] = 0;
+   for (int j = 0; j < parentSize; j++) {
+      int edgeId = Cascade.GetParent(j).edgeId;
+      if (edgeId != -1) shardOffsets[(int64)edgeId * shardNm / edgeNm + 1]++;
+   }
+   for (int s = 0; s < shardNm; s++) shardOffsets[s+1] += shardOffsets[s];
+   for (int j = 0; j < parentSize; j++) {
+      int edgeId = Cascade.GetParent(j).edgeId;
+      if (edgeId != -1) shardEntries[shardOffsets[(int64)edgeId * shardNm / edgeNm]++] = j;
+   }
+   for (int s = shardNm; s > 0; s--) shardOffsets[s] = shardOffsets[s-1];
+   shardOffsets[0] = 0;
+
+   #pragma omp parallel for schedule(dynamic)
+   for (int item = 0; item < latentVariableSize * shardNm; item++) {
+      int k = item / shardNm, s = item % shardNm;
+      EdgeAlphas& alpha = grad.kAlphas.GetDat(k);
+      const double *topicVals = vals + k * parentSize;
+      for (int x = shardOffsets[s]; x < shardOffsets[s+1]; x++) {
+         int j = shardEntries[x];
+         alpha.GetDat(Cascade.GetParent(j).edgeId) += topicVals[j];
       }
    }
 
-   return parameterGrad;
+   delete[] shardOffsets;
+   delete[] shardEntries;
+   delete[] vals;
+   delete[] topicAlphas;
+   delete[] latentProbabilities;
 }
 
 void FASTENFunction::maximize() {
@@ -170,7 +251,7 @@ void FASTENParameter::set(FASTENFunctionConfigure configure) {
 
 void FASTENParameter::init(Data data, TInt NodeNm) {
    for (TInt i=0; i < latentVariableSize; i++) {
-      kAlphas.AddDat(i, THash<TIntPr, TFlt>());
+      kAlphas.AddDat(i, EdgeAlphas());
    }
 }
 
@@ -186,32 +267,32 @@ void FASTENParameter::initPriorTopicProbabilityParameter() {
 
 void FASTENParameter::initAlphaParameter() {
    for (TInt i=0; i < latentVariableSize; i++) {
-      THash<TIntPr, TFlt>& alphas = kAlphas.GetDat(i);
-      for (THash<TIntPr, TFlt>::TIter AI = alphas.BegI(); !AI.IsEnd(); AI++) {
-         AI.GetDat() = TFlt::Rnd.GetUniDev() * (MaxAlpha - MinAlpha) + MinAlpha;
+      EdgeAlphas& alphas = kAlphas.GetDat(i);
+      for (int j=0; j < alphas.Len(); j++) {
+         alphas.GetDat(alphas.GetId(j)) = TFlt::Rnd.GetUniDev() * (MaxAlpha - MinAlpha) + MinAlpha;
       }
    }
 }
 
 void FASTENFunction::initPotentialEdges(Data data) {
-  THash<TInt, TCascade>& cascades = data.cascH;
-  int cascadesNum = cascades.Len();
-  //#pragma omp parallel for
-  for (int i=0;i<cascadesNum;i++) {
-     TCascade& cascade = cascades[i];
-     for (THash<TInt, THitInfo>::TIter srcNI = cascade.BegI(); srcNI < cascade.EndI(); srcNI++) {
-        for (THash<TInt, THitInfo>::TIter dstNI = srcNI; dstNI < cascade.EndI(); dstNI++) {
-           if (srcNI==dstNI) continue;
-           TIntPr key(srcNI.GetKey(), dstNI.GetKey());
-           if (dstNI.GetDat().Tm <= data.time)
-              potentialEdges.AddDat(key, 1.0);
-        } 
-     }
+  if (!edgeSchedule.IsBuilt()) edgeSchedule.Build(data.cascades, minCoOccurrence);
+  edgeSchedule.Activate(data.time, potentialEdges);
+  compiledCascades.Compile(data, potentialEdges, shapingFunction, observedWindow, sparseSurvival);
+
+  const CascadeStore& cascades = data.cascades;
+  int maxCascadeLen = 0;
+  for (int c=0;c<cascades.Len();c++) {
+     if (cascades.GetCascadeLen(c) > maxCascadeLen) maxCascadeLen = cascades.GetCascadeLen(c);
   }
+  decayPowers.Gen(maxCascadeLen);
+  for (int i=0;i<maxCascadeLen;i++) decayPowers[i] = TMath::Power(decayRatio, i);
 }
 
 void FASTENParameter::reset() {
-   kAlphas.Clr();
+   for (THash<TInt, EdgeAlphas>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
+      AI.GetDat().Clr();
+   }
+   kMoments.Clr();
 }
 
 FASTENParameter& FASTENParameter::operator = (const FASTENParameter& p) {
@@ -227,66 +308,51 @@ FASTENParameter& FASTENParameter::operator = (const FASTENParameter& p) {
 }
 
 FASTENParameter& FASTENParameter::operator += (const FASTENParameter& p) {
-   for(THash<TInt, THash<TIntPr, TFlt> >::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+   for(THash<TInt, EdgeAlphas>::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
       TInt key = AI.GetKey();
       if (!kAlphas.IsKey(key)) {
-         kAlphas.AddDat(key, THash<TIntPr, TFlt>());
+         kAlphas.AddDat(key, EdgeAlphas());
       }
 
-      THash<TIntPr, TFlt>& alphas = kAlphas.GetDat(key);
-      for (THash<TIntPr,TFlt>::TIter aI = AI.GetDat().BegI(); !aI.IsEnd(); aI++) {
-         TIntPr alphaIndex = aI.GetKey();
-         TFlt alpha = aI.GetDat();
-         if (!alphas.IsKey(alphaIndex)) alphas.AddDat(alphaIndex, alpha);
-         else alphas.GetDat(alphaIndex) += alpha;
-         //printf("topic: %d, %d,%d: += alpha:%f\n", key(), alphaIndex.Val1(), alphaIndex.Val2(), aI.GetDat());
-      }
+      kAlphas.GetDat(key) += AI.GetDat();
    }
    return *this;
 }
 
 FASTENParameter& FASTENParameter::operator *= (const TFlt multiplier) {
-   for(THash<TInt, THash<TIntPr,TFlt> >::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
-      THash<TIntPr, TFlt>& alphas = AI.GetDat();
-      for (THash<TIntPr,TFlt>::TIter aI = alphas.BegI(); !aI.IsEnd(); aI++) aI.GetDat() *= multiplier;
+   for(THash<TInt, EdgeAlphas>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
+      AI.GetDat() *= multiplier;
    }
    return *this;
 }
 
-FASTENParameter& FASTENParameter::projectedlyUpdateGradient(const FASTENParameter& p) {
-   for(THash<TInt, THash<TIntPr,TFlt> >::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+FASTENParameter& FASTENParameter::projectedlyUpdateGradient(const FASTENParameter& p, const Optimizer& optimizer) {
+   for(THash<TInt, EdgeAlphas>::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
       TInt key = AI.GetKey();
-      THash<TIntPr,TFlt>& alphas = kAlphas.GetDat(key);
-      for (THash<TIntPr,TFlt>::TIter aI = AI.GetDat().BegI(); !aI.IsEnd(); aI++) {
-         TIntPr alphaIndex = aI.GetKey();
-         TFlt alphaGradient = aI.GetDat(), alpha, value;
-         if (alphas.IsKey(alphaIndex)) value = alphas.GetDat(alphaIndex); 
-         else value = InitAlpha;
+      EdgeAlphas& alphas = kAlphas.GetDat(key);
+      EdgeMoments& moments = kMoments.AddDat(key);
+      const EdgeAlphas& alphasGradient = AI.GetDat();
+      for (int i=0; i<alphasGradient.Len(); i++) {
+         TInt edgeId = alphasGradient.GetId(i);
+         TFlt alphaGradient = optimizer.GetStep(moments, edgeId, alphasGradient.GetDat(edgeId)), alpha;
+         TFlt value = alphas.GetDat(edgeId, InitAlpha);
 
          alpha = value - (alphaGradient + (Regularizer ? Mu : TFlt(0.0)) * alpha);
 
          if (alpha < Tol) alpha = Tol;
          if (alpha > MaxAlpha) alpha = MaxAlpha;
 
-         if (!alphas.IsKey(alphaIndex)) alphas.AddDat(alphaIndex, alpha);
-         else alphas.GetDat(alphaIndex) = alpha;
-         //printf("topic: %d, %d,%d: alpha %f -> %f , gradient %f\n", key(), alphaIndex.Val1(), alphaIndex.Val2(), value(), alpha(), alphaGradient());
+         alphas.AddDat(edgeId, alpha);
+         //printf("topic: %d, edge %d: alpha %f -> %f , gradient %f\n", key(), edgeId(), value(), alpha(), alphaGradient());
       }
    }
    return *this;
 }
 
-TFlt FASTENParameter::GetTopicAlpha(TInt srcNId, TInt dstNId, TInt topic) const {
-   const THash<TIntPr, TFlt>& alphas = kAlphas.GetDat(topic);
-   TIntPr index(srcNId,dstNId);
-   if (alphas.IsKey(index)) return alphas.GetDat(index);
-   return InitAlpha;
+TFlt FASTENParameter::GetTopicAlpha(TInt edgeId, TInt topic) const {
+   return kAlphas.GetDat(topic).GetDat(edgeId, InitAlpha);
 }
 
-TFlt FASTENParameter::GetAlpha(TInt srcNId, TInt dstNId, TInt topic) const {
-  const THash<TIntPr,TFlt>& alphas = kAlphas.GetDat(topic);
-  TFlt alpha = 0.0;
-  TIntPr index(srcNId,dstNId);
-  if (!alphas.IsKey(index)) return alpha;
-  return alphas.GetDat(index); 
+TFlt FASTENParameter::GetAlpha(TInt edgeId, TInt topic) const {
+   return kAlphas.GetDat(topic).GetDat(edgeId, 0.0);
 }
@@ -1,16 +1,23 @@
 #include <FASTENModel.h>
+#include <AsyncNetworkWriter.h>
+#include <ResultWriter.h>
+#include <InfectionQueue.h>
 #include <kronecker.h>
 #include <InfoPathFileIO.h>
 #include <cmath>
 
 void FASTENModel::LoadCascadesTxt(const TStr& InFNm) {
-   TFIn FIn(InFNm);
-   InfoPathFileIO::LoadCascadesTxt(FIn, CascH, nodeInfo);
+   InfoPathFileIO::LoadCascadesTxt(InFNm, CascH, nodeInfo);
+   CascStore.Pack(CascH, nodeInfo.NodeNmH);
+}
+
+void FASTENModel::LoadCascadesBin(const TStr& InFNm) {
+   CascH.Clr();
+   InfoPathFileIO::LoadCascadesBin(InFNm, CascStore, nodeInfo);
 }
 
 void FASTENModel::LoadGroundTruthTxt(const TStr& InFNm) {
-   TFIn FIn(InFNm);
-   InfoPathFileIO::LoadNetworkTxt(FIn, Network, nodeInfo);
+   InfoPathFileIO::LoadNetworkTxt(InFNm, Network, nodeInfo);
 }
 
 void FASTENModel::SaveInferred(const TStr& OutFNm) {
@@ -28,7 +35,7 @@ void FASTENModel::SavePriorTopicProbability(const TStr& OutFNm) {
 }
 
 void FASTENModel::ReadAlphas(const TStr& InFNm) {
-  for ( THash<TInt, THash<TIntPr,TFlt> >::TIter AI = lossFunction.parameter.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+  for ( THash<TInt, EdgeAlphas>::TIter AI = lossFunction.parameter.kAlphas.BegI(); !AI.IsEnd(); AI++) {
      TInt key = AI.GetKey() + 1;
      TStr FNm = InFNm + "-" + key.GetStr() + "-network.txt";
      TFIn FIn(FNm);
@@ -38,8 +45,8 @@ void FASTENModel::ReadAlphas(const TStr& InFNm) {
         TStrV tokens;
         line.SplitOnAllCh(',', tokens);
         if (tokens.Len()==4) {
-           TIntPr index(tokens[0].GetInt(), tokens[1].GetInt());
-           AI.GetDat().AddDat(index, tokens[3].GetFlt());
+           TInt edgeId = lossFunction.potentialEdges.AddEdge(tokens[0].GetInt(), tokens[1].GetInt());
+           AI.GetDat().AddDat(edgeId, tokens[3].GetFlt());
         }
      }
   }
@@ -62,9 +69,72 @@ void FASTENModel::ReadPriorTopicProbability(const TStr& InFNm) {
 }
 
 void FASTENModel::GenCascade(TCascade& C) {
+	TInt topic;
+	TIntPrV UsedEdgeV;
+	GenCascade(C, TFlt::Rnd, TInt::Rnd, topic, UsedEdgeV);
+	AddUsedEdges(topic, UsedEdgeV);
+}
+
+// Seed of the random stream of cascade CId: SplitMix64 of (Seed, CId), folded
+// into the positive range TRnd takes (0 would seed it from the clock).
+static int GetCascadeSeed(const int Seed, const int CId) {
+	uint64 z = ((uint64)(unsigned int)Seed << 32 | (unsigned int)CId) + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z ^= z >> 31;
+	return 1 + int(z % 2147483646ULL);
+}
+
+// Cascades are simulated in blocks, in parallel, each from its own random
+// stream, so the output does not depend on the number of threads. A block is
+// written out in cascade order before the next one starts.
+void FASTENModel::GenCascades(const int CascadeNm, const int Seed, const TStr& OutFNm) {
+	const int BlockLen = 4096;
+	TVec<TCascade> CascadeV(BlockLen);
+	TIntV TopicV(BlockLen);
+	TVec<TIntPrV> UsedEdgeVV(BlockLen);
+
+	ResultWriter writer(OutFNm);
+	writer.PutNodes(nodeInfo.NodeNmH, "\r\n");
+
+	for (int first = 0; first < CascadeNm; first += BlockLen) {
+		const int len = TMath::Mn(BlockLen, CascadeNm - first);
+
+		#pragma omp parallel for schedule(dynamic)
+		for (int i = 0; i < len; i++) {
+			TRnd Rnd(GetCascadeSeed(Seed, first + i));
+			CascadeV[i] = TCascade(first + i, nodeInfo.Model);
+			GenCascade(CascadeV[i], Rnd, Rnd, TopicV[i], UsedEdgeVV[i]);
+		}
+
+		for (int i = 0; i < len; i++) {
+			const TCascade& C = CascadeV[i];
+			AddUsedEdges(TopicV[i], UsedEdgeVV[i]);
+			writer.PutCascade(C, nodeInfo.NodeNmH);
+
+			printf("cascade:%d (%d nodes, first infection:%f, last infection:%f)\n", first + i, C.Len(), C.GetMinTm(), C.GetMaxTm());
+
+			// check the cascade last more than Window
+			IAssert( (C.GetMaxTm() - C.GetMinTm()) <= Window );
+		}
+	}
+}
+
+void FASTENModel::AddUsedEdges(const TInt topic, const TIntPrV& UsedEdgeV) {
+	if (UsedEdgeV.Empty()) return;
+	THash<TIntPr,TFlt>& topicEdges = usedEdges.GetDat(topic);
+	for (int i = 0; i < UsedEdgeV.Len(); i++) topicEdges.AddDat(UsedEdgeV[i], 1.0);
+}
+
+// Event-driven simulation: nodes wait in a heap by infection time and each
+// runs its infection once, in time order. A node whose time reaches the end of
+// the window is final and never enters the heap. Reads the model only, so
+// cascades can be simulated concurrently with their own FltRnd and IntRnd.
+void FASTENModel::GenCascade(TCascade& C, TRnd& FltRnd, TRnd& IntRnd, TInt& topic, TIntPrV& UsedEdgeV) {
 	bool verbose = false;
 	TIntFltH InfectedNIdH; TIntH InfectedBy;
-	double GlobalTime, InitTime;
+	InfectionQueue Queue;
+	double GlobalTime, InitTime, EndTime;
 	double alpha;
 	int StartNId;
 
@@ -76,14 +146,17 @@ void FASTENModel::GenCascade(TCascade& C) {
 
 	while (C.Len() < 2) {
 		C.Clr();
-		InfectedNIdH.Clr();
-		InfectedBy.Clr();
+		InfectedNIdH.Clr(false);
+		InfectedBy.Clr(false);
+		Queue.Clr();
+		UsedEdgeV.Clr(false);
 
-		InitTime = TFlt::Rnd.GetUniDev() * TotalTime; // random starting point <TotalTime
+		InitTime = FltRnd.GetUniDev() * TotalTime; // random starting point <TotalTime
+		EndTime = TFlt::GetMn(InitTime+Window, TotalTime);
 		GlobalTime = InitTime;
 
-                TInt topic = -1;
-                TFlt sampledValue = TFlt::Rnd.GetUniDev();
+                topic = -1;
+                TFlt sampledValue = FltRnd.GetUniDev();
                 for (THash<TInt,TFlt>::TIter VI = lossFunction.parameter.priorTopicProbability.BegI(); !VI.IsEnd(); VI++) {
                    sampledValue -= VI.GetDat();
                    if (sampledValue <= 0.0) {
@@ -92,42 +165,41 @@ void FASTENModel::GenCascade(TCascade& C) {
                    }
                 }
                 //printf("start NId %d, topic %d\n", StartNId, topic());
-                TInt selectedIndex = TInt::Rnd.GetUniDevInt(outputEdgeMap.GetDat(topic).Len());
+                TInt selectedIndex = IntRnd.GetUniDevInt(outputEdgeMap.GetDat(topic).Len());
 		StartNId = outputEdgeMap.GetDat(topic).GetDat(selectedIndex);
 		InfectedNIdH.AddDat(StartNId) = GlobalTime;
-
+		if (GlobalTime < EndTime) Queue.Push(StartNId, GlobalTime);
 
                 TFlt nodePosition = 0.0;
-		while (true) {
-			// sort by time & get the oldest node that did not run infection
-			InfectedNIdH.SortByDat(true);
-			const int& NId = InfectedNIdH.BegI().GetKey();
-			GlobalTime = InfectedNIdH.BegI().GetDat();
-
-                        //printf("source NId %d, topic %d\n", NId, topic());
-			// all the nodes has run infection
-			if ( GlobalTime >= TFlt::GetMn(TotalTime, InitTime+Window) )
-				break;
+		while (!Queue.Empty()) {
+			// get the oldest node that did not run infection
+			const int NId = Queue.GetMinNId();
+			GlobalTime = Queue.GetMinTm();
+			Queue.PopMin();
 
 			// add current oldest node to the network and set its time
 			C.Add(NId, GlobalTime);
+			// it runs infection only once, so its time becomes final
+			InfectedNIdH.GetDat(NId) = EndTime;
 
 			if (verbose) { printf("GlobalTime:%f, infected node:%d\n", GlobalTime, NId); }
 
+			const double decay = TMath::Power(fastenFunctionConfigure.decayRatio, nodePosition);
+
 			// run infection from the current oldest node
 			TStrFltFltHNEDNet::TNodeI NI = Network.GetNI(NId);
 			for (int e = 0; e < NI.GetOutDeg(); e++) {
 				const int DstNId = NI.GetOutNId(e);
 
 				// choose the current tx rate (we assume the most recent tx rate)
-				if (Network.IsEdge(NId,DstNId) && Network.GetEDat(NId, DstNId).Len() > 0) {
-				   TFltFltH& Alphas = Network.GetEDat(NId, DstNId);
+				const TFltFltH& Alphas = NI.GetOutEDat(e);
+				if (Alphas.Len() > 0) {
 				   for (int j=0; j<Alphas.Len() && Alphas.GetKey(j)<GlobalTime; j++) { alpha = Alphas[j]; }
                                 }
 				else alpha = (double)lossFunction.GetAlpha(NId, DstNId, topic);
 				if (verbose) { printf("GlobalTime:%f, nodes:%d->%d, alpha:%f\n", GlobalTime, NId, DstNId, alpha); }
 
-                                alpha /= TMath::Power(fastenFunctionConfigure.decayRatio, nodePosition);
+                                alpha /= decay;
 				if (alpha <= edgeInfo.MinAlpha) { continue; }
 
 				// not infecting the parent
@@ -138,16 +210,16 @@ void FASTENModel::GenCascade(TCascade& C) {
 				switch (nodeInfo.Model) {
 				case EXP:
 					// exponential with alpha parameter
-					sigmaT = TFlt::Rnd.GetExpDev(alpha);
+					sigmaT = FltRnd.GetExpDev(alpha);
 					break;
 				case POW:
 					// power-law with alpha parameter
-					sigmaT = TInt::Rnd.GetPowerDev(1+alpha);
-					while (sigmaT < Delta) { sigmaT = Delta * TFlt::Rnd.GetPowerDev(1+alpha); }
+					sigmaT = IntRnd.GetPowerDev(1+alpha);
+					while (sigmaT < Delta) { sigmaT = Delta * FltRnd.GetPowerDev(1+alpha); }
 					break;
 				case RAY:
 					// rayleigh with alpha parameter
-					sigmaT = TFlt::Rnd.GetRayleigh(1/sqrt(alpha));
+					sigmaT = FltRnd.GetRayleigh(1/sqrt(alpha));
 					break;
 				default:
 					sigmaT = 1;
@@ -156,28 +228,26 @@ void FASTENModel::GenCascade(TCascade& C) {
 
 				IAssert(sigmaT >= 0);
 
-				double t1 = TFlt::GetMn(GlobalTime + sigmaT, TFlt::GetMn(InitTime+Window, TotalTime));
+				double t1 = TFlt::GetMn(GlobalTime + sigmaT, EndTime);
 
 				if (InfectedNIdH.IsKey(DstNId)) {
 					double t2 = InfectedNIdH.GetDat(DstNId);
-					if ( t2 > t1 && t2 < TFlt::GetMn(InitTime+Window, TotalTime)) {
+					if ( t2 > t1 && t2 < EndTime) {
 						InfectedNIdH.GetDat(DstNId) = t1;
 						InfectedBy.GetDat(DstNId) = NId;
-                                                TIntPr index(NId,DstNId);
-                                                usedEdges.GetDat(topic).AddDat(index,1.0);
+						Queue.DecreaseKey(DstNId, t1);
+                                                UsedEdgeV.Add(TIntPr(NId,DstNId));
 					}
 				} else {
 					InfectedNIdH.AddDat(DstNId) = t1;
 					InfectedBy.AddDat(DstNId) = NId;
-                                        if (t1 < TFlt::GetMn(InitTime+Window, TotalTime)) {
-                                           TIntPr index(NId,DstNId);
-                                           usedEdges.GetDat(topic).AddDat(index,1.0);
+                                        if (t1 < EndTime) {
+                                           Queue.Push(DstNId, t1);
+                                           UsedEdgeV.Add(TIntPr(NId,DstNId));
                                         }
 				}
 			}
 
-			// we cannot delete key (otherwise, we cannot sort), so we assign a big time (InitTime + window cut-off)
-			InfectedNIdH.GetDat(NId) = TFlt::GetMn(InitTime+Window, TotalTime);
                         nodePosition++;
 		}
     }
@@ -188,7 +258,7 @@ void FASTENModel::GenCascade(TCascade& C) {
 
 void FASTENModel::GenerateGroundTruth(const int& TNetwork, const int& NNodes, const int& NEdges, const TStr& NetworkParams) {
    TIntFltH positionHash;
-   Data data = {nodeInfo.NodeNmH, CascH, positionHash, 0};
+   Data data = {nodeInfo.NodeNmH, CascStore, positionHash, 0};
    lossFunction.set(fastenFunctionConfigure);
    lossFunction.init(data, NNodes);
 
@@ -244,8 +314,8 @@ void FASTENModel::GenerateGroundTruth(const int& TNetwork, const int& NNodes, co
              if (EI.GetSrcNId()==EI.GetDstNId()) { continue; } 
              if (!Network.IsEdge(EI.GetSrcNId(),EI.GetDstNId()))
                 Network.AddEdge(EI.GetSrcNId(),EI.GetDstNId(),TFltFltH()); 
-             TIntPr index(EI.GetSrcNId(),EI.GetDstNId());
-             lossFunction.parameter.kAlphas.GetDat(i).AddDat(index, 0.0);
+             TInt edgeId = lossFunction.potentialEdges.AddEdge(EI.GetSrcNId(),EI.GetDstNId());
+             lossFunction.parameter.kAlphas.GetDat(i).AddDat(edgeId, 0.0);
           }
 
 	  if (verbose) { printf("Network structure has been generated succesfully!\n"); }
@@ -256,9 +326,9 @@ void FASTENModel::GenerateGroundTruth(const int& TNetwork, const int& NNodes, co
    
    for (TInt i=0; i < eMConfigure.latentVariableSize; i++) {
       outputEdgeMap.AddDat(i, THash<TInt, TInt>());
-      TInt edgeNum = 0;
-      for (THash<TIntPr,TFlt>::TIter EI = lossFunction.parameter.kAlphas.GetDat(i).BegI(); !EI.IsEnd(); EI++,edgeNum++) {
-         TInt srcNId = EI.GetKey().Val1;
+      const EdgeAlphas& alphas = lossFunction.parameter.kAlphas.GetDat(i);
+      for (TInt edgeNum = 0; edgeNum < alphas.Len(); edgeNum++) {
+         TInt srcNId = lossFunction.potentialEdges.GetEdge(alphas.GetId(edgeNum)).Val1;
          outputEdgeMap.GetDat(i).AddDat(edgeNum, srcNId);
       }
    }
@@ -267,43 +337,38 @@ void FASTENModel::GenerateGroundTruth(const int& TNetwork, const int& NNodes, co
 void FASTENModel::SaveGroundTruth(TStr fileNm) {
    printf("ground truth\n");
 
+   TVec<ResultWriter*> writers;
    for (TInt latentVariable=0; latentVariable < fastenFunctionConfigure.latentVariableSize; latentVariable++) {
-      TFOut FOut(fileNm + TStr::Fmt("-%d-network.txt", latentVariable+1));
-      for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
-         FOut.PutStr(TStr::Fmt("%d,%s\n", NI.GetKey().Val, NI.GetDat().Name.CStr()));
-      }
-      FOut.PutStr("\n");
+      writers.Add(new ResultWriter(fileNm + TStr::Fmt("-%d-network.txt", latentVariable+1), BinaryEdges));
+      writers.Last()->PutNodes(nodeInfo.NodeNmH);
    }
 
    for (TStrFltFltHNEDNet::TEdgeI EI = Network.BegEI(); EI < Network.EndEI(); EI++) {
       TInt srcNId = EI.GetSrcNId(), dstNId = EI.GetDstNId();
       TIntPr index(srcNId, dstNId);
+      TInt edgeId = lossFunction.potentialEdges.GetEdgeId(srcNId, dstNId);
 
       TFlt maxValue = -DBL_MAX;
       printf("%d,%d , \n", srcNId(), dstNId());
       for (TInt latentVariable=0; latentVariable < fastenFunctionConfigure.latentVariableSize; latentVariable++) {
-         THash<TIntPr, TFlt>& alphas = lossFunction.parameter.kAlphas.GetDat(latentVariable); 
-
-         TFlt alpha = 0.0;
-         if (alphas.IsKey(index)) alpha = alphas.GetDat(index);
+         TFlt alpha = lossFunction.parameter.GetAlpha(edgeId, latentVariable);
          if (alpha > maxValue) maxValue = alpha;
 
          printf("\t\ttopic %d alpha:%f \n", latentVariable(), alpha());
          if (alpha > edgeInfo.MinAlpha and usedEdges.GetDat(latentVariable).IsKey(index)) {
-            TFOut FOut(fileNm + TStr::Fmt("-%d-network.txt", latentVariable+1), true);
-            FOut.PutStr(TStr::Fmt("%d,%d,%f,%f\n", srcNId, dstNId, 0.0, alpha));  
+            writers[latentVariable]->PutEdge(srcNId, dstNId, 0.0, alpha);
          }
       }
       printf("\n");
       EI.GetDat().AddDat(0.0, maxValue);
    }
+
+   for (int i=0; i<writers.Len(); i++) delete writers[i];
 }
 
 void FASTENModel::Init() {
-   for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
-      InferredNetwork.AddNode(NI.GetKey(), NI.GetDat().Name);
-      MaxNetwork.AddNode(NI.GetKey(), NI.GetDat().Name);
-   }
+   InferredNetwork.Clr();
+   MaxNetwork.Clr();
 }
 
 void FASTENModel::Infer(const TFltV& Steps, const TStr& OutFNm) {
@@ -320,8 +385,10 @@ void FASTENModel::Infer(const TFltV& Steps, const TStr& OutFNm) {
    } 
    lossFunction.set(fastenFunctionConfigure);
    em.set(eMConfigure);
+   // nodes of the ground truth that are in no cascade go after the others
+   CascStore.AddNodes(nodeInfo.NodeNmH);
    TIntFltH CascadesPositions;
-   Data data = {nodeInfo.NodeNmH, CascH, CascadesPositions, 0.0};
+   Data data = {nodeInfo.NodeNmH, CascStore, CascadesPositions, 0.0};
    lossFunction.init(data);
 
    TStr expName, resultDir, outName, modelName;
@@ -333,61 +400,30 @@ void FASTENModel::Infer(const TFltV& Steps, const TStr& OutFNm) {
    TSampling Sampling = eMConfigure.pGDConfigure.sampling;
    TStrV ParamSamplingV; eMConfigure.pGDConfigure.ParamSampling.SplitOnAllCh(';', ParamSamplingV);
 
+   AsyncNetworkWriter writer(InferredNetwork, MaxNetwork, nodeInfo.NodeNmH, OutFNm, fastenFunctionConfigure.MinAlpha, Aging, BinaryEdges);
    for (int t=1; t<Steps.Len(); t++) {
       TIntFltH CascadesPositions;
-      for (int i=0; i<CascH.Len(); i++) {
-         if (CascH[i].LenBeforeT(Steps[t]) > 1 &&
+      for (int i=0; i<CascStore.Len(); i++) {
+         if (CascStore.GetLenBeforeT(i, Steps[t]) > 1 &&
             ( (Sampling!=WIN_SAMPLING && Sampling!=WIN_EXP_SAMPLING) ||
-              (Sampling==WIN_SAMPLING && (Steps[t]-CascH[i].GetMinTm()) <= ParamSamplingV[0].GetFlt()) ||
-              (Sampling==WIN_EXP_SAMPLING && (Steps[t]-CascH[i].GetMinTm()) <= ParamSamplingV[0].GetFlt()) )) {
-            CascadesPositions.AddDat(i) = CascH[i].GetMinTm();
+              (Sampling==WIN_SAMPLING && (Steps[t]-CascStore.GetMinTm(i)) <= ParamSamplingV[0].GetFlt()) ||
+              (Sampling==WIN_EXP_SAMPLING && (Steps[t]-CascStore.GetMinTm(i)) <= ParamSamplingV[0].GetFlt()) )) {
+            CascadesPositions.AddDat(i) = CascStore.GetMinTm(i);
          }
       }
-      Data data = {nodeInfo.NodeNmH, CascH, CascadesPositions, Steps[t]};
+      Data data = {nodeInfo.NodeNmH, CascStore, CascadesPositions, Steps[t]};
       lossFunction.initPotentialEdges(data);
       em.Optimize(lossFunction, data);
 
-      const THash<TInt, THash<TIntPr, TFlt> >& kAlphas = lossFunction.getParameter().kAlphas;
+      const THash<TInt, EdgeAlphas>& kAlphas = lossFunction.getParameter().kAlphas;
 
       THash<TInt, TFlt> kPi;
       for (TInt topic = 0; topic < eMConfigure.latentVariableSize; topic ++) kPi.AddDat(topic, lossFunction.parameter.priorTopicProbability.GetDat(topic));
 
-      for (THash<TInt, THash<TIntPr, TFlt> >::TIter NI = kAlphas.BegI(); !NI.IsEnd(); NI++) {
-         TInt key = NI.GetKey();
-         const THash<TIntPr, TFlt>& alphas = NI.GetDat();
-         TStrFltFltHNEDNet& inferredNetwork = InferredNetwork;
-
-         TFOut FOut(OutFNm + TStr("_") + key.GetStr() + ".txt");
-
-         for (THash<TInt, TNodeInfo>::TIter NodeI = nodeInfo.NodeNmH.BegI(); NodeI < nodeInfo.NodeNmH.EndI(); NodeI++) {
-            FOut.PutStr(TStr::Fmt("%d,%s\n", NodeI.GetKey().Val, NodeI.GetDat().Name.CStr()));
-         }
-         FOut.PutStr("\n");
-
-         int i=0;
-         for (THash<TIntPr, TFlt>::TIter AI = alphas.BegI(); !AI.IsEnd(); AI++,i++) {
-            if (i%100000==0) printf("add kAlphas: %d, alphas length: %d, alpha index: %d\n", NI.GetKey()(),alphas.Len(),i);
-            TInt srcNId = AI.GetKey().Val1, dstNId = AI.GetKey().Val2;
- 
-            TFlt alpha = AI.GetDat();
-            if (inferredNetwork.IsEdge(srcNId, dstNId) && inferredNetwork.GetEDat(srcNId, dstNId).IsKey(Steps[t-1]) && 
-                alpha == inferredNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t-1]))
-               alpha = alpha * Aging;
-            
-            if (alpha <= fastenFunctionConfigure.MinAlpha) continue;
-            if (!inferredNetwork.IsEdge(srcNId, dstNId)) inferredNetwork.AddEdge(srcNId, dstNId, TFltFltH());
-            if (!MaxNetwork.IsEdge(srcNId, dstNId)) MaxNetwork.AddEdge(srcNId, dstNId, TFltFltH());
- 
-            FOut.PutStr(TStr::Fmt("%d,%d,%f,%f\n", srcNId, dstNId, Steps[t], alpha));
-
-            if (!inferredNetwork.GetEDat(srcNId, dstNId).IsKey(Steps[t])) inferredNetwork.GetEDat(srcNId,dstNId).AddDat(Steps[t], alpha * kPi.GetDat(key));
-            else InferredNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t]) += alpha * kPi.GetDat(key);
-
-            if (!MaxNetwork.GetEDat(srcNId, dstNId).IsKey(Steps[t])) MaxNetwork.GetEDat(srcNId,dstNId).AddDat(Steps[t], alpha);
-            else if (MaxNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t]) < alpha) MaxNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t]) = alpha;
-         }
-      }   
+      for (THash<TInt, EdgeAlphas>::TIter NI = kAlphas.BegI(); !NI.IsEnd(); NI++) writer.AddTopic(NI.GetKey(), kPi.GetDat(NI.GetKey()), NI.GetDat(), lossFunction.potentialEdges);
+      writer.Write(Steps[t], Steps[t-1]);
    }
+   writer.Wait();
    InfoPathFileIO::SaveNetwork(OutFNm + "_Max.txt", MaxNetwork, nodeInfo, edgeInfo);
    delete fastenFunctionConfigure.shapingFunction;
 }
@@ -0,0 +1,64 @@
+#include <InfectionQueue.h>
+
+void InfectionQueue::Push(const TInt NId, const double time) {
+   nodes.Add(NId);
+   times.Add(time);
+   positionH.AddDat(NId, nodes.Len() - 1);
+   SiftUp(nodes.Len() - 1);
+}
+
+void InfectionQueue::DecreaseKey(const TInt NId, const double time) {
+   int position = positionH.GetDat(NId);
+   IAssert(time <= times[position]);
+   times[position] = time;
+   SiftUp(position);
+}
+
+void InfectionQueue::PopMin() {
+   positionH.DelKey(nodes[0]);
+   TInt NId = nodes.Last();
+   double time = times.Last();
+   nodes.DelLast();
+   times.DelLast();
+   if (nodes.Empty()) return;
+   Place(0, NId, time);
+   SiftDown(0);
+}
+
+void InfectionQueue::Clr() {
+   nodes.Clr(false);
+   times.Clr(false);
+   positionH.Clr(false);
+}
+
+void InfectionQueue::Place(const int position, const TInt NId, const double time) {
+   nodes[position] = NId;
+   times[position] = time;
+   positionH.GetDat(NId) = position;
+}
+
+void InfectionQueue::SiftUp(int position) {
+   TInt NId = nodes[position];
+   double time = times[position];
+   while (position > 0) {
+      int parent = (position - 1) / 2;
+      if (times[parent] <= time) break;
+      Place(position, nodes[parent], times[parent]);
+      position = parent;
+   }
+   Place(position, NId, time);
+}
+
+void InfectionQueue::SiftDown(int position) {
+   TInt NId = nodes[position];
+   double time = times[position];
+   while (true) {
+      int child = 2 * position + 1;
+      if (child >= nodes.Len()) break;
+      if (child + 1 < nodes.Len() && times[child + 1] < times[child]) child++;
+      if (times[child] >= time) break;
+      Place(position, nodes[child], times[child]);
+      position = child;
+   }
+   Place(position, NId, time);
+}
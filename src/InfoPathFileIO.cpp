@@ -1,4 +1,111 @@
 #include <InfoPathFileIO.h>
+#include <ResultWriter.h>
+#include <omp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// A text file mapped into memory. The lines after the node header are cut
+// into chunks that end at a newline, so that each chunk can be parsed by a
+// different thread.
+class TextChunks {
+   public:
+      TextChunks(const TStr& InFNm) : bf(NULL), bfL(0), bodyBeg(0) {
+         int fd = open(InFNm.CStr(), O_RDONLY);
+         EAssertR(fd != -1, TStr::Fmt("Can not open %s", InFNm.CStr()));
+         struct stat st;
+         if (fstat(fd, &st) == 0) bfL = st.st_size;
+         if (bfL > 0) {
+            void *mapped = mmap(NULL, bfL, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) bf = static_cast<const char*>(mapped);
+         }
+         close(fd);
+         EAssertR(bfL == 0 || bf != NULL, TStr::Fmt("Can not map %s", InFNm.CStr()));
+
+         // the header ends with the first empty line, as in LoadNodes
+         const char *at = bf, *lineBeg, *lineEnd;
+         while (NextLine(at, bf + bfL, lineBeg, lineEnd) && lineBeg != lineEnd) {}
+         bodyBeg = at - bf;
+      }
+      ~TextChunks() { if (bf != NULL) munmap(const_cast<char*>(bf), bfL); }
+
+      const char* GetHeader() const { return bf; }
+      int GetHeaderLen() const { return (int)bodyBeg; }
+
+      void Split(const int chunkNm) {
+         chunkBegs.Clr();
+         chunkBegs.Add(bodyBeg);
+         int64 chunkLen = (bfL - bodyBeg) / chunkNm + 1;
+         for (int i=1; i<chunkNm; i++) {
+            int64 at = bodyBeg + i * chunkLen;
+            if (at <= chunkBegs.Last()) continue;
+            if (at >= bfL) break;
+            const char *nl = static_cast<const char*>(memchr(bf + at, '\n', bfL - at));
+            if (nl == NULL) break;
+            chunkBegs.Add(nl + 1 - bf);
+         }
+         chunkBegs.Add(bfL);
+      }
+      int Len() const { return chunkBegs.Len() - 1; }
+      const char* GetBeg(const int i) const { return bf + chunkBegs[i]; }
+      const char* GetEnd(const int i) const { return bf + chunkBegs[i+1]; }
+
+      // Next line of [at, end) without its line break, like TSIn::GetNextLn.
+      static bool NextLine(const char*& at, const char *end, const char*& lineBeg, const char*& lineEnd) {
+         if (at >= end) return false;
+         const char *nl = static_cast<const char*>(memchr(at, '\n', end - at));
+         lineBeg = at;
+         lineEnd = nl == NULL ? end : nl;
+         at = nl == NULL ? end : nl + 1;
+         if (lineEnd > lineBeg && lineEnd[-1] == '\r') lineEnd--;
+         return true;
+      }
+
+   private:
+      const char *bf;
+      int64 bfL, bodyBeg;
+      TVec<int64> chunkBegs;
+};
+
+// Next non-empty field of [at, end), split as TStr::SplitOnAllCh does.
+static bool NextField(const char*& at, const char *end, const char sep, const char*& fieldBeg, const char*& fieldEnd) {
+   while (at < end && *at == sep) at++;
+   if (at >= end) return false;
+   fieldBeg = at;
+   while (at < end && *at != sep) at++;
+   fieldEnd = at;
+   return true;
+}
+
+static int CountFields(const char *beg, const char *end, const char sep) {
+   int fieldNm = 0;
+   const char *fieldBeg, *fieldEnd;
+   while (NextField(beg, end, sep, fieldBeg, fieldEnd)) fieldNm++;
+   return fieldNm;
+}
+
+// Numbers of a field without copying it into a TStr.
+static int FieldToInt(const char *beg, const char *end) {
+   bool isNeg = beg < end && *beg == '-';
+   if (beg < end && (*beg == '-' || *beg == '+')) beg++;
+   int val = 0;
+   for (; beg < end && *beg >= '0' && *beg <= '9'; beg++) val = 10 * val + (*beg - '0');
+   return isNeg ? -val : val;
+}
+
+static double FieldToFlt(const char *beg, const char *end) {
+   char num[64];
+   int len = end - beg < 63 ? int(end - beg) : 63;
+   memcpy(num, beg, len);
+   num[len] = 0;
+   return strtod(num, NULL);
+}
+
+typedef struct {
+   int srcNId, dstNId;
+   TFltFltH alphas;
+}EdgeLine;
 
 void InfoPathFileIO::LoadNodes(TSIn& SIn, NodeInfo &nodeInfo, bool verbose) {
   TStr Line;
@@ -54,6 +161,155 @@ void InfoPathFileIO::LoadCascadesTxt(TSIn& SIn, THash<TInt, TCascade>& CascH, No
   if (verbose) printf("All cascades read!\n");
 }
 
+// Builds the packed store without going through TCascade. The nodes of the
+// file come first in the store, in the order of nodeInfo.NodeNmH.
+void InfoPathFileIO::LoadCascadesTxt(TSIn& SIn, CascadeStore& cascades, NodeInfo &nodeInfo, bool verbose) {
+  LoadNodes(SIn, nodeInfo, verbose);
+  cascades.Clr();
+  cascades.AddNodes(nodeInfo.NodeNmH);
+  TStr Line;
+  while (!SIn.Eof()) { SIn.GetNextLn(Line); AddCasc(Line, cascades, nodeInfo); }
+  if (verbose) printf("All cascades read!\n");
+}
+
+// Maps a file written by SaveCascadesBin. The node names of the file also
+// fill nodeInfo.DomainsIdH, as LoadNodes does for text files.
+void InfoPathFileIO::LoadCascadesBin(const TStr& InFNm, CascadeStore& cascades, NodeInfo &nodeInfo, bool verbose) {
+  cascades.LoadBin(InFNm, nodeInfo.NodeNmH);
+  for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
+    if (!IsDomainNm(NI.GetDat().Name, nodeInfo)) AddDomainNm(NI.GetDat().Name, nodeInfo, NI.GetKey());
+  }
+  if (verbose) printf("All cascades mapped (%d cascades, %d hits)!\n", cascades.Len(), cascades.GetHitNm());
+}
+
+// Parallel version of LoadCascadesTxt: the chunks of the file are parsed
+// into cascades on all threads and added to CascH in file order, so CascH
+// and the Vol counts come out as with the serial parser.
+void InfoPathFileIO::LoadCascadesTxt(const TStr& InFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, bool verbose) {
+  ParseCascadesTxt(InFNm, CascH, nodeInfo, false, verbose);
+}
+
+// Parses the cascade of one line into C and counts its hits in vols, which
+// is indexed by key id in NodeNmH. Returns false if a hit is of a node that
+// is not in NodeNmH.
+bool InfoPathFileIO::ParseCasc(const char *beg, const char *end, const THash<TInt, TNodeInfo>& NodeNmH, TIntV& vols, TCascade& C) {
+  // support cascade id if any
+  const char *at = beg, *fieldBeg, *fieldEnd, *idBeg = NULL, *idEnd = NULL;
+  int fieldNm = 0;
+  while (NextField(at, end, ';', fieldBeg, fieldEnd)) {
+    if (fieldNm == 0) { idBeg = fieldBeg; idEnd = fieldEnd; }
+    fieldNm++;
+  }
+  if (fieldNm == 0) return true;
+  if (fieldNm == 2) C.CId = FieldToInt(idBeg, idEnd);
+
+  // read nodes from the last field
+  bool isKnown = true;
+  at = fieldBeg;
+  const char *nIdBeg = NULL, *nIdEnd = NULL, *tmBeg, *tmEnd;
+  while (NextField(at, fieldEnd, ',', nIdBeg, nIdEnd) && NextField(at, fieldEnd, ',', tmBeg, tmEnd)) {
+    int NId = FieldToInt(nIdBeg, nIdEnd);
+    int keyId = NodeNmH.GetKeyId(NId);
+    if (keyId == -1) { isKnown = false; continue; }
+    vols[keyId]++;
+    C.Add(NId, FieldToFlt(tmBeg, tmEnd));
+  }
+  C.Sort();
+  return isKnown;
+}
+
+void InfoPathFileIO::ParseCascadesTxt(const TStr& InFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, const bool renumber, bool verbose) {
+  TextChunks chunks(InFNm);
+  TMIn MIn(chunks.GetHeader(), chunks.GetHeaderLen());
+  LoadNodes(MIn, nodeInfo, verbose);
+
+  int threadNm = omp_get_max_threads();
+  chunks.Split(8 * threadNm);
+  TVec<TVec<TCascade> > chunkCascades(chunks.Len());
+  TVec<TIntV> threadVols(threadNm);
+  bool isUnknownNode = false;
+
+  #pragma omp parallel reduction(||:isUnknownNode)
+  {
+    TIntV& vols = threadVols[omp_get_thread_num()];
+    vols.Gen(nodeInfo.NodeNmH.Len());
+    #pragma omp for schedule(dynamic)
+    for (int i=0; i<chunks.Len(); i++) {
+      const char *at = chunks.GetBeg(i), *lineBeg, *lineEnd;
+      while (TextChunks::NextLine(at, chunks.GetEnd(i), lineBeg, lineEnd)) {
+        if (lineBeg == lineEnd) continue;
+        TCascade& C = chunkCascades[i][chunkCascades[i].Add(TCascade(-1, nodeInfo.Model))];
+        if (!ParseCasc(lineBeg, lineEnd, nodeInfo.NodeNmH, vols, C)) isUnknownNode = true;
+      }
+    }
+  }
+  EAssertR(!isUnknownNode, TStr::Fmt("%s has hits of nodes that are not in its node list", InFNm.CStr()));
+
+  for (int t=0; t<threadNm; t++) {
+    for (int node=0; node<threadVols[t].Len(); node++) nodeInfo.NodeNmH[node].Vol += threadVols[t][node];
+  }
+
+  for (int i=0; i<chunks.Len(); i++) {
+    for (int j=0; j<chunkCascades[i].Len(); j++) {
+      TCascade& C = chunkCascades[i][j];
+      if (renumber) C.CId = CascH.Len();
+      CascH.AddDat(C.CId) = C;
+    }
+    chunkCascades[i].Clr();
+  }
+  if (verbose) printf("All cascades read!\n");
+}
+
+// Parallel version of LoadNetworkTxt, the edges are added in file order.
+void InfoPathFileIO::LoadNetworkTxt(const TStr& InFNm, TStrFltFltHNEDNet& Network, NodeInfo &nodeInfo, bool verbose) {
+  TextChunks chunks(InFNm);
+  Network.Clr(); // clear network (if any)
+
+  TMIn MIn(chunks.GetHeader(), chunks.GetHeaderLen());
+  LoadNodes(MIn, nodeInfo, verbose);
+  for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
+    Network.AddNode(NI.GetKey(), NI.GetDat().Name);
+  }
+
+  chunks.Split(8 * omp_get_max_threads());
+  TVec<TVec<EdgeLine> > chunkEdges(chunks.Len());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int i=0; i<chunks.Len(); i++) {
+    const char *at = chunks.GetBeg(i), *lineBeg, *lineEnd;
+    while (TextChunks::NextLine(at, chunks.GetEnd(i), lineBeg, lineEnd)) {
+      if (lineBeg == lineEnd) continue;
+      EdgeLine& edge = chunkEdges[i][chunkEdges[i].Add()];
+      int fieldNm = CountFields(lineBeg, lineEnd, ',');
+      const char *fieldAt = lineBeg, *fieldBeg, *fieldEnd, *tmBeg = NULL, *tmEnd = NULL;
+      for (int j=0; NextField(fieldAt, lineEnd, ',', fieldBeg, fieldEnd); j++) {
+        if (j == 0) edge.srcNId = FieldToInt(fieldBeg, fieldEnd);
+        else if (j == 1) edge.dstNId = FieldToInt(fieldBeg, fieldEnd);
+        else if (fieldNm == 3) edge.alphas.AddDat(0.0) = FieldToFlt(fieldBeg, fieldEnd);
+        else if (j % 2 == 0) { tmBeg = fieldBeg; tmEnd = fieldEnd; }
+        else edge.alphas.AddDat(FieldToFlt(tmBeg, tmEnd)) = FieldToFlt(fieldBeg, fieldEnd);
+      }
+    }
+  }
+
+  for (int i=0; i<chunks.Len(); i++) {
+    for (int j=0; j<chunkEdges[i].Len(); j++) {
+      EdgeLine& edge = chunkEdges[i][j];
+      Network.AddEdge(edge.srcNId, edge.dstNId, edge.alphas);
+
+      if (verbose) {
+        printf("Edge %d -> %d: ", edge.srcNId, edge.dstNId);
+        TFltFltH &AlphasE = Network.GetEDat(edge.srcNId, edge.dstNId);
+        for (int k=0; k<AlphasE.Len(); k+=2) { printf("(%f, %f)", AlphasE.GetKey(k).Val, AlphasE[k].Val); }
+        printf("\n");
+      }
+    }
+    chunkEdges[i].Clr();
+  }
+
+  if (verbose) printf("network nodes:%d edges:%d\n", Network.GetNodes(), Network.GetEdges());
+}
+
 void InfoPathFileIO::LoadNetworkTxt(TSIn& SIn, TStrFltFltHNEDNet& Network, NodeInfo &nodeInfo, bool verbose) {
   TStr Line;
 
@@ -99,6 +355,19 @@ void InfoPathFileIO::AddCascadesTxt(TSIn& SIn, THash<TInt, TCascade>& CascH, Nod
    if (verbose) printf("All cascades read!\n");
 }
 
+// Parallel version of AddCascadesTxt.
+void InfoPathFileIO::AddCascadesTxt(const TStr& InFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, bool verbose) {
+   ParseCascadesTxt(InFNm, CascH, nodeInfo, true, verbose);
+}
+
+void InfoPathFileIO::AddCascadesTxt(TSIn& SIn, CascadeStore& cascades, NodeInfo &nodeInfo, bool verbose) {
+   LoadNodes(SIn, nodeInfo, verbose);
+   cascades.AddNodes(nodeInfo.NodeNmH);
+   TStr Line;
+   while (!SIn.Eof()) { SIn.GetNextLn(Line); AddCasc(Line, cascades, nodeInfo, cascades.Len()); }
+   if (verbose) printf("All cascades read!\n");
+}
+
 void InfoPathFileIO::AddNetworkTxt(TSIn& SIn, TStrFltFltHNEDNet& Network, NodeInfo &nodeInfo, bool verbose) {
    LoadAndAddNodes(SIn, Network, nodeInfo, verbose);
   
@@ -141,16 +410,16 @@ void InfoPathFileIO::AddNetworkTxt(TSIn& SIn, TStrFltFltHNEDNet& Network, NodeIn
 }
 
 void InfoPathFileIO::SaveNetwork(const TStr& OutFNm, TStrFltFltHNEDNet& Network, NodeInfo &nodeInfo, EdgeInfo &edgeInfo, const TIntV& NIdV) {
-  TFOut FOut(OutFNm);
+  ResultWriter writer(OutFNm);
 
   // write nodes to file
   for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
     if (NIdV.Len() > 0 && !NIdV.IsIn(NI.GetKey())) { continue; }
 
-    FOut.PutStr(TStr::Fmt("%d,%s\r\n", NI.GetKey().Val, NI.GetDat().Name.CStr()));
+    writer.PutInt(NI.GetKey()); writer.PutCh(','); writer.PutStr(NI.GetDat().Name); writer.PutStr("\r\n");
   }
 
-  FOut.PutStr("\r\n");
+  writer.PutStr("\r\n");
 
   // write edges to file (not allowing self loops in the network)
   for (TStrFltFltHNEDNet::TEdgeI EI = Network.BegEI(); EI < Network.EndEI(); EI++) {
@@ -160,54 +429,102 @@ void InfoPathFileIO::SaveNetwork(const TStr& OutFNm, TStrFltFltHNEDNet& Network,
     // not allowing self loops in the Kronecker network
     if (EI.GetSrcNId() != EI.GetDstNId()) {
       if (EI().Len() > 0) {
-        TStr Line; bool IsEdge = false;
+        // if none of the alphas is bigger than 0, no edge is written
+        bool IsEdge = false;
+        for (int i=0; i<EI().Len() && !IsEdge; i++) { IsEdge = EI()[i] > edgeInfo.MinAlpha; }
+        if (!IsEdge) { continue; }
+
+        writer.PutInt(EI.GetSrcNId()); writer.PutCh(','); writer.PutInt(EI.GetDstNId());
         for (int i=0; i<EI().Len(); i++) {
+          writer.PutCh(','); writer.PutFlt(EI().GetKey(i));
           if (EI()[i]> edgeInfo.MinAlpha) {
-            Line += TStr::Fmt(",%f,%f", EI().GetKey(i).Val, (EI()[i] > edgeInfo.MaxAlpha? edgeInfo.MaxAlpha.Val : EI()[i].Val) );
-            IsEdge = true;
+            writer.PutCh(','); writer.PutFlt(EI()[i] > edgeInfo.MaxAlpha? edgeInfo.MaxAlpha.Val : EI()[i].Val);
           } else { // we write 0 explicitly
-            Line += TStr::Fmt(",%f,0.0", EI().GetKey(i).Val);
+            writer.PutStr(",0.0");
           }
         }
-        // if none of the alphas is bigger than 0, no edge is written
-        if (IsEdge) {
-          FOut.PutStr(TStr::Fmt("%d,%d", EI.GetSrcNId(), EI.GetDstNId()));
-          FOut.PutStr(Line);
-          FOut.PutStr("\r\n");
-        }
+        writer.PutStr("\r\n");
+      }
+      else {
+        writer.PutInt(EI.GetSrcNId()); writer.PutCh(','); writer.PutInt(EI.GetDstNId()); writer.PutStr(",1\r\n");
       }
-      else
-        FOut.PutStr(TStr::Fmt("%d,%d,1\r\n", EI.GetSrcNId(), EI.GetDstNId()));
     }
   }
 }
 
-void InfoPathFileIO::SaveCascades(const TStr& OutFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo) {
-  TFOut FOut(OutFNm);
+// Same file as SaveNetwork of the graph the network replaces: edges by the
+// NodeNmH order of their source and then by destination id, and the alphas of
+// an edge in step order.
+void InfoPathFileIO::SaveNetwork(const TStr& OutFNm, const TemporalNetwork& Network, NodeInfo &nodeInfo, EdgeInfo &edgeInfo) {
+  ResultWriter writer(OutFNm);
+  writer.PutNodes(nodeInfo.NodeNmH, "\r\n");
+
+  // steps at which each edge has an alpha, grouped by edge
+  TIntV offsets(Network.GetEdges() + 1);
+  for (int step=0; step<Network.GetSteps(); step++) {
+    const EdgeAlphas& alphas = Network.GetStepAlphas(step);
+    for (int i=0; i<alphas.Len(); i++) offsets[alphas.GetId(i) + 1]++;
+  }
+  for (int e=0; e<Network.GetEdges(); e++) offsets[e+1] += offsets[e];
+  TIntV edgeSteps(offsets.Last());
+  TIntV fill(offsets);
+  for (int step=0; step<Network.GetSteps(); step++) {
+    const EdgeAlphas& alphas = Network.GetStepAlphas(step);
+    for (int i=0; i<alphas.Len(); i++) edgeSteps[fill[alphas.GetId(i)]++] = step;
+  }
 
-  // write nodes to file
-  for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
-    FOut.PutStr(TStr::Fmt("%d,%s\r\n", NI.GetKey().Val, NI.GetDat().Name.CStr()));
+  TVec<TTriple<TInt, TInt, TInt> > order;
+  for (int e=0; e<Network.GetEdges(); e++) {
+    const TIntPr& edge = Network.GetEdge(e);
+    int srcKeyId = nodeInfo.NodeNmH.GetKeyId(edge.Val1);
+    if (srcKeyId == -1 || !nodeInfo.NodeNmH.IsKey(edge.Val2)) { continue; }
+    // not allowing self loops in the network
+    if (edge.Val1 == edge.Val2) { continue; }
+    order.Add(TTriple<TInt, TInt, TInt>(srcKeyId, edge.Val2, e));
   }
+  order.Sort();
+
+  for (int i=0; i<order.Len(); i++) {
+    int e = order[i].Val3;
+    const TIntPr& edge = Network.GetEdge(e);
+    if (offsets[e] == offsets[e+1]) {
+      writer.PutInt(edge.Val1); writer.PutCh(','); writer.PutInt(edge.Val2); writer.PutStr(",1\r\n");
+      continue;
+    }
 
-  FOut.PutStr("\r\n");
+    // if none of the alphas is bigger than 0, no edge is written
+    bool IsEdge = false;
+    for (int j=offsets[e]; j<offsets[e+1] && !IsEdge; j++) { IsEdge = Network.GetDat(edgeSteps[j], e) > edgeInfo.MinAlpha; }
+    if (!IsEdge) { continue; }
+
+    writer.PutInt(edge.Val1); writer.PutCh(','); writer.PutInt(edge.Val2);
+    for (int j=offsets[e]; j<offsets[e+1]; j++) {
+      TFlt alpha = Network.GetDat(edgeSteps[j], e);
+      writer.PutCh(','); writer.PutFlt(Network.GetStep(edgeSteps[j]));
+      if (alpha > edgeInfo.MinAlpha) {
+        writer.PutCh(','); writer.PutFlt(alpha > edgeInfo.MaxAlpha? edgeInfo.MaxAlpha.Val : alpha.Val);
+      } else { // we write 0 explicitly
+        writer.PutStr(",0.0");
+      }
+    }
+    writer.PutStr("\r\n");
+  }
+}
+
+void InfoPathFileIO::SaveCascades(const TStr& OutFNm, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo) {
+  ResultWriter writer(OutFNm);
+  writer.PutNodes(nodeInfo.NodeNmH, "\r\n");
 
   // write cascades to file
   for (THash<TInt, TCascade>::TIter CI = CascH.BegI(); CI < CascH.EndI(); CI++) {
-    TCascade &C = CI.GetDat();
-    int j = 0;
-    for (THash<TInt, THitInfo>::TIter NI = C.NIdHitH.BegI(); NI < C.NIdHitH.EndI(); NI++) {
-      if (!nodeInfo.NodeNmH.IsKey(NI.GetDat().NId)) { continue; }
-      if (j > 0) { FOut.PutStr(TStr::Fmt(",%d,%f", NI.GetDat().NId.Val, NI.GetDat().Tm.Val)); }
-      else { FOut.PutStr(TStr::Fmt("%d;%d,%f", CI.GetKey().Val, NI.GetDat().NId.Val, NI.GetDat().Tm.Val)); }
-      j++;
-    }
-
-    if (j >= 1)
-      FOut.PutStr(TStr::Fmt("\r\n"));
+    writer.PutCascade(CI.GetDat(), nodeInfo.NodeNmH);
   }
 }
 
+void InfoPathFileIO::SaveCascadesBin(const TStr& OutFNm, const CascadeStore& cascades, NodeInfo &nodeInfo) {
+  cascades.SaveBin(OutFNm, nodeInfo.NodeNmH);
+}
+
 void InfoPathFileIO::AddCasc(const TStr& CascStr, THash<TInt, TCascade>& CascH, NodeInfo &nodeInfo, int CId) {
   // support cascade id if any
   TStrV FieldsV; CascStr.SplitOnAllCh(';', FieldsV);
@@ -228,6 +545,25 @@ void InfoPathFileIO::AddCasc(const TStr& CascStr, THash<TInt, TCascade>& CascH,
   CascH.AddDat(C.CId) = C;
 }
 
+void InfoPathFileIO::AddCasc(const TStr& CascStr, CascadeStore& cascades, NodeInfo &nodeInfo, int CId) {
+  // support cascade id if any
+  TStrV FieldsV; CascStr.SplitOnAllCh(';', FieldsV);
+  if (FieldsV.Len()==2) { 
+     if (CId==-1) CId = FieldsV[0].GetInt(); 
+  }
+
+  // read nodes
+  TStrV NIdV; FieldsV[FieldsV.Len()-1].SplitOnAllCh(',', NIdV);
+  TFltIntPrV TmNIdV(NIdV.Len()/2, 0);
+  for (int i = 0; i < NIdV.Len(); i+=2) {
+    int NId = NIdV[i].GetInt();
+    double Tm = NIdV[i+1].GetFlt();
+    nodeInfo.NodeNmH.GetDat(NId).Vol += 1;
+    TmNIdV.Add(TFltIntPr(Tm, NId));
+  }
+  cascades.AddCascade(CId, TmNIdV);
+}
+
 void InfoPathFileIO::AddNodeNm(const int& NId, const TNodeInfo& Info, NodeInfo &nodeInfo) {
    nodeInfo.NodeNmH.AddDat(NId, Info);  
 }
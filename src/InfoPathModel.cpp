@@ -1,13 +1,17 @@
 #include <InfoPathModel.h>
 
 void InfoPathModel::LoadCascadesTxt(const TStr& InFNm) {
-   TFIn FIn(InFNm);
-   InfoPathFileIO::LoadCascadesTxt(FIn, CascH, nodeInfo);
+   InfoPathFileIO::LoadCascadesTxt(InFNm, CascH, nodeInfo);
+   CascStore.Pack(CascH, nodeInfo.NodeNmH);
+}
+
+void InfoPathModel::LoadCascadesBin(const TStr& InFNm) {
+   CascH.Clr();
+   InfoPathFileIO::LoadCascadesBin(InFNm, CascStore, nodeInfo);
 }
 
 void InfoPathModel::LoadGroundTruthTxt(const TStr& InFNm) {
-   TFIn FIn(InFNm);
-   InfoPathFileIO::LoadNetworkTxt(FIn, Network, nodeInfo);
+   InfoPathFileIO::LoadNetworkTxt(InFNm, Network, nodeInfo);
 }
 
 void InfoPathModel::SaveInferred(const TStr& OutFNm) {
@@ -15,9 +19,7 @@ void InfoPathModel::SaveInferred(const TStr& OutFNm) {
 }
 
 void InfoPathModel::Init() {
-   for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
-      InferredNetwork.AddNode(NI.GetKey(), NI.GetDat().Name);
-   }
+   InferredNetwork.Clr();
 }
 
 void InfoPathModel::Infer(const TFltV& Steps) {
@@ -34,39 +36,44 @@ void InfoPathModel::Infer(const TFltV& Steps) {
    } 
    lossFunction.set(additiveRiskFunctionConfigure);
    pgd.set(pGDConfigure);
+   // nodes of the ground truth that are in no cascade go after the others
+   CascStore.AddNodes(nodeInfo.NodeNmH);
    
    TSampling Sampling = pGDConfigure.sampling;
    TStrV ParamSamplingV; pGDConfigure.ParamSampling.SplitOnAllCh(';', ParamSamplingV);
 
    for (int t=1; t<Steps.Len(); t++) {
       TIntFltH CascadesPositions;
-      for (int i=0; i<CascH.Len(); i++) {
-         if (CascH[i].LenBeforeT(Steps[t]) > 1 &&
+      for (int i=0; i<CascStore.Len(); i++) {
+         if (CascStore.GetLenBeforeT(i, Steps[t]) > 1 &&
             ( (Sampling!=WIN_SAMPLING && Sampling!=WIN_EXP_SAMPLING) ||
-              (Sampling==WIN_SAMPLING && (Steps[t]-CascH[i].GetMinTm()) <= ParamSamplingV[0].GetFlt()) ||
-              (Sampling==WIN_EXP_SAMPLING && (Steps[t]-CascH[i].GetMinTm()) <= ParamSamplingV[0].GetFlt()) )) {
-            CascadesPositions.AddDat(i) = CascH[i].GetMinTm();
+              (Sampling==WIN_SAMPLING && (Steps[t]-CascStore.GetMinTm(i)) <= ParamSamplingV[0].GetFlt()) ||
+              (Sampling==WIN_EXP_SAMPLING && (Steps[t]-CascStore.GetMinTm(i)) <= ParamSamplingV[0].GetFlt()) )) {
+            CascadesPositions.AddDat(i) = CascStore.GetMinTm(i);
          }
       }
-      Data data = {nodeInfo.NodeNmH, CascH, CascadesPositions, Steps[t]};
+      Data data = {nodeInfo.NodeNmH, CascStore, CascadesPositions, Steps[t]};
       lossFunction.initPotentialEdges(data);
       pgd.Optimize(lossFunction, data);
 
-      const THash<TIntPr, TFlt> &alphas = lossFunction.parameter.alphas;
+      const EdgeAlphas &alphas = lossFunction.parameter.alphas;
+      int step = InferredNetwork.AddStep(Steps[t]), prevStep = InferredNetwork.GetStepIdx(Steps[t-1]);
 
-      for (THash<TIntPr, TFlt>::TIter AI = alphas.BegI(); !AI.IsEnd(); AI++) {
-         TInt srcNId = AI.GetKey().Val1, dstNId = AI.GetKey().Val2;
+      for (int i=0; i<alphas.Len(); i++) {
+         TInt edgeId = alphas.GetId(i);
+         const TIntPr& edge = lossFunction.potentialEdges.GetEdge(edgeId);
+         TInt srcNId = edge.Val1, dstNId = edge.Val2;
 
-         TFlt alpha = AI.GetDat();
+         TFlt alpha = alphas.GetDat(edgeId);
          if (alpha < edgeInfo.MinAlpha) continue;
-         if (!InferredNetwork.IsEdge(srcNId, dstNId)) InferredNetwork.AddEdge(srcNId, dstNId, TFltFltH());
+         TInt inferredId = InferredNetwork.AddEdge(srcNId, dstNId);
 
-         if (InferredNetwork.GetEDat(srcNId, dstNId).IsKey(Steps[t-1]) && alpha == InferredNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t-1]))
+         if (InferredNetwork.IsDat(prevStep, inferredId) && alpha == InferredNetwork.GetDat(prevStep, inferredId))
             alpha = alpha * Aging;
          if (alpha > edgeInfo.MaxAlpha) alpha = edgeInfo.MaxAlpha;
 
  
-         InferredNetwork.GetEDat(srcNId,dstNId).AddDat(Steps[t]) = alpha;          
+         InferredNetwork.AddDat(step, inferredId, alpha);          
       }
       
    }
@@ -1,36 +1,69 @@
 #include <InfoPathSampler.h>
+#include <cmath>
 
-int InfoPathSampler::sample(const TSampling& Sampling, const TStr& ParamSampling, const int range) {
+void InfoPathSampler::set(const TSampling& sampling, const TStr& ParamSampling) {
+   Sampling = sampling;
+   Scale = 0.0;
 
-   int sampleValue = -1;
    TStrV ParamSamplingV; ParamSampling.SplitOnAllCh(';', ParamSamplingV);
-
    switch (Sampling) {
-     case UNIF_SAMPLING:
-       sampleValue = TInt::Rnd.GetUniDevInt(range);
+     case EXP_SAMPLING:
+     case RAY_SAMPLING:
+       Scale = ParamSamplingV[0].GetFlt();
        break;
 
-     case WIN_SAMPLING:
-       sampleValue = TInt::Rnd.GetUniDevInt(range);
+     case WIN_EXP_SAMPLING:
+       Scale = ParamSamplingV[1].GetFlt();
        break;
 
-     case EXP_SAMPLING:
-       do {
-         sampleValue = (int)TFlt::Rnd.GetExpDev(ParamSamplingV[0].GetFlt());
-       } while (sampleValue > range-1);
+     default:
        break;
+   }
+}
 
+int InfoPathSampler::sample(const int range, TRnd& IntRnd, TRnd& FltRnd) const {
+   double x;
+   switch (Sampling) {
+     case EXP_SAMPLING:
      case WIN_EXP_SAMPLING:
-       do {
-         sampleValue = (int)TFlt::Rnd.GetExpDev(ParamSamplingV[1].GetFlt());
-       } while (sampleValue > range-1);
+       // F(x) = 1 - exp(-rate x), truncated at range
+       x = -log1p(FltRnd.GetUniDev() * expm1(-Scale * range)) / Scale;
        break;
 
      case RAY_SAMPLING:
-       do {
-         sampleValue = (int)TFlt::Rnd.GetRayleigh(ParamSamplingV[0].GetFlt());
-       } while (sampleValue > range-1);
+       // F(x) = 1 - exp(-x^2 / (2 sigma^2)), truncated at range
+       x = Scale * sqrt(-2.0 * log1p(FltRnd.GetUniDev() * expm1(-range * (range / (2.0 * Scale * Scale)))));
        break;
+
+     default:
+       return IntRnd.GetUniDevInt(range);
+   }
+   // x < range, but rounding may reach it
+   return TMath::Mn((int)x, range-1);
+}
+
+void InfoPathSampler::sample(const int range, const int sampleNm, TIntV& indices, TRnd& IntRnd, TRnd& FltRnd) const {
+   // nothing to draw from
+   if (range <= 0) {
+      indices.Clr();
+      return;
+   }
+   if (Epochs) {
+      shuffle(range, sampleNm, indices, IntRnd);
+      return;
+   }
+   indices.Gen(sampleNm);
+   for (int i=0; i<sampleNm; i++) indices[i] = sample(range, IntRnd, FltRnd);
+}
+
+// Fisher-Yates shuffle of [0, range), once per epoch.
+void InfoPathSampler::shuffle(const int range, const int sampleNm, TIntV& indices, TRnd& IntRnd) const {
+   indices.Gen(sampleNm);
+   TIntV epoch(range);
+   for (int first=0; first<sampleNm; first+=range) {
+      for (int i=0; i<range; i++) epoch[i] = i;
+      for (int i=range-1; i>0; i--) epoch.Swap(i, IntRnd.GetUniDevInt(i+1));
+      int len = TMath::Mn(range, sampleNm-first);
+      for (int i=0; i<len; i++) indices[first+i] = epoch[i];
    }
-   return sampleValue;
 }
@@ -1,186 +1,168 @@
 #include <MMRateFunction.h>
 
 TFlt MMRateFunction::JointLikelihood(Datum datum, TInt latentVariable) const {
-   double CurrentTime = datum.time;
-   TCascade &Cascade = datum.cascH.GetDat(datum.index);
-   THash<TInt, TNodeInfo> &NodeNmH = datum.NodeNmH;
-   TFlt totalLoss = 0.0;
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
+   double totalLoss = 0.0;
    TFlt diffusionPattern;
    if (parameter.diffusionPatterns.IsKey(datum.index)) diffusionPattern = parameter.diffusionPatterns.GetDat(datum.index);
    else diffusionPattern = parameter.InitDiffusionPattern;
-   const THash<TIntPr, TFlt>& alphas = parameter.kAlphas.GetDat(latentVariable);
-
-   int nodeSize = NodeNmH.Len();
-   float *lossTable = new float[nodeSize];
-   #pragma omp parallel for
-   for (int i=0;i<nodeSize;i++) {
-      TInt key = NodeNmH.GetKey(i);
-      TInt dstNId = key, srcNId;
-      TFlt sumInLog = 0.0, val = 0.0;
-      TFlt dstTime, srcTime;
-      lossTable[i] = 0.0;
-
-      if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime) dstTime = Cascade.GetTm(dstNId);
-      else dstTime = Cascade.GetMaxTm() + observedWindow;
-
-      for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++) {
-         srcNId = CascadeNI.GetKey();
-         srcTime = CascadeNI.GetDat().Tm;
-
-         if (!shapingFunction->Before(srcTime,dstTime)) break; 
-                        
-         TIntPr alphaIndex; alphaIndex.Val1 = srcNId; alphaIndex.Val2 = dstNId;
-
-         TFlt alpha = 0.0;
-         if (potentialEdges.IsKey(alphaIndex)) {
-            if (alphas.IsKey(alphaIndex)) alpha = alphas.GetDat(alphaIndex);
-            else alpha = parameter.InitAlpha;
-            alpha += diffusionPattern;
-         }
+   const EdgeAlphas& alphas = parameter.kAlphas.GetDat(latentVariable);
+
+   int dstSize = Cascade.Len();
+   double *sumInLogs = new double[dstSize];
+   #pragma omp parallel for reduction(+:totalLoss)
+   for (int i=0;i<dstSize;i++) {
+      double sumInLog = 0.0, val = 0.0;
+
+      for (int j=Cascade.GetBeg(i);j<Cascade.GetEnd(i);j++) {
+         const ParentEntry &parent = Cascade.GetParent(j);
+         if (parent.edgeId == -1) continue;
 
-         sumInLog += alpha * shapingFunction->Value(srcTime,dstTime);
-         val += alpha * shapingFunction->Integral(srcTime,dstTime);
-         //printf("sumInLog:%f,val:%f, alpha:%f, shapingVal:%f, shapingInt:%f\n",sumInLog(),val(),alpha(),shapingFunction->Value(srcTime,dstTime)(),shapingFunction->Integral(srcTime,dstTime)()); 
+         double alpha = alphas.GetDat(parent.edgeId, parameter.InitAlpha) + diffusionPattern;
+         sumInLog += alpha * parent.value;
+         val += alpha * parent.integral;
       }
-      lossTable[i] = val;
-      
-      if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime && sumInLog!=0.0) lossTable[i] -= TMath::Log(sumInLog);
-      
-   }
 
-   for (int i=0;i<nodeSize;i++) totalLoss += lossTable[i];
-   delete[] lossTable;
+      sumInLogs[i] = (Cascade.IsInfected(i) && sumInLog!=0.0) ? sumInLog : 1.0;
+      totalLoss += val;
+   }
+   totalLoss -= BatchLogSum(sumInLogs, dstSize);
+   delete[] sumInLogs;
 
-   //printf("datum:%d, Myloss:%f\n",datum.index(), totalLoss());
+   //printf("datum:%d, Myloss:%f\n",datum.index(), totalLoss);
    TFlt logP = -1.0 * totalLoss;
    TFlt logPi = TMath::Log(parameter.kPi.GetDat(latentVariable));
    //printf("logP: %f, logPi=%f\n",logP(),logPi());
    return logP + logPi;
 }
 
-MMRateParameter& MMRateFunction::gradient(Datum datum) {
-   parameterGrad.reset();
-      
-   double CurrentTime = datum.time;
-   TCascade &Cascade = datum.cascH.GetDat(datum.index);
-   THash<TInt, TNodeInfo> &NodeNmH = datum.NodeNmH;
+// All topics in one sweep over the compiled cascade; the inner loops run over
+// the topics of one parent entry.
+void MMRateFunction::JointLikelihoodAllTopics(Datum datum, double *jointLikelihoods) const {
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
    TFlt diffusionPattern;
    if (parameter.diffusionPatterns.IsKey(datum.index)) diffusionPattern = parameter.diffusionPatterns.GetDat(datum.index);
    else diffusionPattern = parameter.InitDiffusionPattern;
 
-   for (THash<TInt, THash<TIntPr, TFlt> >::TIter AI = parameter.kAlphas.BegI(); !AI.IsEnd(); AI++) {
-      TInt key = AI.GetKey();
-      THash<TIntPr, TFlt>& alphasGradient = parameterGrad.kAlphas.GetDat(key);
-      THash<TIntPr, TFlt>& alphas = parameter.kAlphas.GetDat(key);
-
-      int nodeSize = NodeNmH.Len();
-      int cascadeSize = Cascade.Len();
-      int *srcNIds = new int[nodeSize * cascadeSize];
-      int *dstNIds = new int[nodeSize * cascadeSize];
-      float *vals  = new float[nodeSize * cascadeSize];
-      float *diffusionPatternVals = new float[nodeSize];
-    
-      for (int i=0;i<nodeSize;i++) {
-         diffusionPatternVals[i] = 0.0;
-         for (int j=0;j<cascadeSize;j++) {
-            int index = i*cascadeSize + j;
-            srcNIds[index] = dstNIds[index] = -1;
-            vals[index] = -1.0;
+   int latentVariableSize = parameter.latentVariableSize;
+   const EdgeAlphas **topicAlphas = new const EdgeAlphas*[latentVariableSize];
+   double *totalLosses = new double[latentVariableSize];
+   for (int k = 0; k < latentVariableSize; k++) {
+      topicAlphas[k] = &parameter.kAlphas.GetDat(k);
+      totalLosses[k] = 0.0;
+   }
+
+   int dstSize = Cascade.Len();
+   // sumInLogs[k * dstSize + i]
+   double *sumInLogs = new double[latentVariableSize * dstSize];
+
+   #pragma omp parallel
+   {
+      double *sumInLog = new double[latentVariableSize];
+      double *val = new double[latentVariableSize];
+      double *losses = new double[latentVariableSize];
+      for (int k = 0; k < latentVariableSize; k++) losses[k] = 0.0;
+
+      #pragma omp for
+      for (int i=0;i<dstSize;i++) {
+         for (int k = 0; k < latentVariableSize; k++) sumInLog[k] = val[k] = 0.0;
+
+         for (int j=Cascade.GetBeg(i);j<Cascade.GetEnd(i);j++) {
+            const ParentEntry &parent = Cascade.GetParent(j);
+            if (parent.edgeId == -1) continue;
+
+            for (int k = 0; k < latentVariableSize; k++) {
+               double alpha = topicAlphas[k]->GetDat(parent.edgeId, parameter.InitAlpha) + diffusionPattern;
+               sumInLog[k] += alpha * parent.value;
+               val[k] += alpha * parent.integral;
+            }
+         }
+
+         for (int k = 0; k < latentVariableSize; k++) {
+            sumInLogs[k * dstSize + i] = (Cascade.IsInfected(i) && sumInLog[k]!=0.0) ? sumInLog[k] : 1.0;
+            losses[k] += val[k];
          }
       }
+
+      #pragma omp critical
+      for (int k = 0; k < latentVariableSize; k++) totalLosses[k] += losses[k];
+
+      delete[] sumInLog;
+      delete[] val;
+      delete[] losses;
+   }
+
+   for (int k = 0; k < latentVariableSize; k++) {
+      double totalLoss = totalLosses[k] - BatchLogSum(sumInLogs + k * dstSize, dstSize);
+      jointLikelihoods[k] = TMath::Log(parameter.kPi.GetDat(k)) - totalLoss;
+   }
+
+   delete[] topicAlphas;
+   delete[] totalLosses;
+   delete[] sumInLogs;
+}
+
+void MMRateFunction::gradient(Datum datum, MMRateParameter& grad) const {
+   grad.reset();
+      
+   const CompiledCascade &Cascade = compiledCascades.GetCascade(datum);
+   TFlt diffusionPattern;
+   if (parameter.diffusionPatterns.IsKey(datum.index)) diffusionPattern = parameter.diffusionPatterns.GetDat(datum.index);
+   else diffusionPattern = parameter.InitDiffusionPattern;
+
+   int dstSize = Cascade.Len();
+   int parentSize = Cascade.GetParentNm();
+   double *vals = new double[parentSize];
+
+   for (THash<TInt, EdgeAlphas>::TIter AI = parameter.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+      TInt key = AI.GetKey();
+      EdgeAlphas& alphasGradient = grad.kAlphas.AddDat(key);
+      const EdgeAlphas& alphas = AI.GetDat();
+      TFlt latentProbability = GetLatentProbability(datum, key);
    
       #pragma omp parallel for
-      for (int i=0;i<nodeSize;i++) {
-         TInt dstNId = NodeNmH.GetKey(i), srcNId;
-         TFlt sumInLog = 0.0, val = 0.0;
-         TFlt dstTime, srcTime;
+      for (int i=0;i<dstSize;i++) {
+         int beg = Cascade.GetBeg(i), end = Cascade.GetEnd(i);
+         double sumInLog = 0.0;
    
-         if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime) {
-            dstTime = Cascade.GetTm(dstNId);
-            for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++) {
-               srcNId = CascadeNI.GetKey();
-               srcTime = CascadeNI.GetDat().Tm;
-   
-               if (!shapingFunction->Before(srcTime,dstTime)) break; 
-                           
-               TIntPr alphaIndex; alphaIndex.Val1 = srcNId; alphaIndex.Val2 = dstNId;
-   
-               TFlt alpha;
-               if (alphas.IsKey(alphaIndex)) alpha = alphas.GetDat(alphaIndex);
-               else alpha = parameter.InitAlpha;
-               alpha += diffusionPattern;
-            
-               sumInLog += alpha * shapingFunction->Value(srcTime,dstTime);
-               //printf("sumInLog:%f, alpha:%f, val:%f, initAlpha:%f\n",sumInLog(),alpha(),shapingFunction->Value(srcTime,dstTime)(),parameter.InitAlpha());
+         if (Cascade.IsInfected(i)) {
+            for (int j=beg;j<end;j++) {
+               const ParentEntry &parent = Cascade.GetParent(j);
+               sumInLog += (alphas.GetDat(parent.edgeId, parameter.InitAlpha) + diffusionPattern) * parent.value;
+            }
+            for (int j=beg;j<end;j++) {
+               const ParentEntry &parent = Cascade.GetParent(j);
+               vals[j] = parent.integral - parent.value/sumInLog;
             }
          }
-         else dstTime = Cascade.GetMaxTm() + observedWindow;
-   
-         int j=0;
-         for (THash<TInt, THitInfo>::TIter CascadeNI = Cascade.BegI(); CascadeNI < Cascade.EndI(); CascadeNI++,j++) {
-            srcNId = CascadeNI.GetKey();
-            srcTime = CascadeNI.GetDat().Tm;
-   
-            if (!shapingFunction->Before(srcTime,dstTime)) break; 
-            TIntPr key(srcNId, dstNId);
-            if (!potentialEdges.IsKey(key)) continue;
-                           
-            TIntPr alphaIndex; alphaIndex.Val1 = srcNId; alphaIndex.Val2 = dstNId;
-            if (Cascade.IsNode(dstNId) && Cascade.GetTm(dstNId) <= CurrentTime)
-               val = shapingFunction->Integral(srcTime,dstTime) - shapingFunction->Value(srcTime,dstTime)/sumInLog;
-            else
-               val = shapingFunction->Integral(srcTime,dstTime);
-               
-            int index = i*cascadeSize + j;
-            srcNIds[index] = srcNId();
-            dstNIds[index] = dstNId();
-            vals[index] = val();
-            diffusionPatternVals[i] += val();
-            //printf("index:%d, %d,%d: gradient:%f, shapingVal:%f, sumInLog:%f\n",datum.index(),srcNId(),dstNId(),val(),shapingFunction->Integral(srcTime,dstTime)(),sumInLog()); 
+         else {
+            for (int j=beg;j<end;j++) vals[j] = Cascade.GetParent(j).integral;
          }
       }
    
-      float diffusionPatternGradient = 0.0;
-      for (int i=0;i<nodeSize;i++) {
-         diffusionPatternGradient += diffusionPatternVals[i];
-         for (int j=0;j<cascadeSize;j++) {
-            int index = i*cascadeSize + j;
-            if (srcNIds[index]==-1) break;
-            TIntPr alphaIndex; alphaIndex.Val1 = srcNIds[index]; alphaIndex.Val2 = dstNIds[index];
-            alphasGradient.AddDat(alphaIndex, vals[index] * latentDistributions.GetDat(datum.index).GetDat(key));
-         }
+      double diffusionPatternGradient = 0.0;
+      for (int j=0;j<parentSize;j++) {
+         int edgeId = Cascade.GetParent(j).edgeId;
+         if (edgeId == -1) continue;
+         diffusionPatternGradient += vals[j];
+         alphasGradient.AddDat(edgeId, vals[j] * latentProbability);
       }
-      diffusionPatternGradient *= latentDistributions.GetDat(datum.index).GetDat(key);
-      if (!parameterGrad.diffusionPatterns.IsKey(datum.index)) parameterGrad.diffusionPatterns.AddDat(datum.index, diffusionPatternGradient);
-      else parameterGrad.diffusionPatterns.GetDat(datum.index) += diffusionPatternGradient;
-   
-      delete[] srcNIds;
-      delete[] dstNIds;
-      delete[] vals;
-      delete[] diffusionPatternVals;
+      diffusionPatternGradient *= latentProbability;
+      if (!grad.diffusionPatterns.IsKey(datum.index)) grad.diffusionPatterns.AddDat(datum.index, diffusionPatternGradient);
+      else grad.diffusionPatterns.GetDat(datum.index) += diffusionPatternGradient;
    
-      //printf("index:%d, k:%d, latent distribution:%f\n",datum.index(), key(), latentDistributions.GetDat(datum.index).GetDat(key)());     
-      parameterGrad.kPi.GetDat(key) = latentDistributions.GetDat(datum.index).GetDat(key);
-      parameterGrad.kPi_times.GetDat(key)++; 
+      //printf("index:%d, k:%d, latent distribution:%f\n",datum.index(), key(), latentProbability());     
+      grad.kPi.AddDat(key) = latentProbability;
+      grad.kPi_times.AddDat(key)++; 
    }
-   return parameterGrad;
+
+   delete[] vals;
 }
 
 void MMRateFunction::initPotentialEdges(Data data) {
-  THash<TInt, TCascade>& cascades = data.cascH;
-  int cascadesNum = cascades.Len();
-  //#pragma omp parallel for
-  for (int i=0;i<cascadesNum;i++) {
-     TCascade& cascade = cascades[i];
-     for (THash<TInt, THitInfo>::TIter srcNI = cascade.BegI(); srcNI < cascade.EndI(); srcNI++) {
-        for (THash<TInt, THitInfo>::TIter dstNI = srcNI; dstNI < cascade.EndI(); dstNI++) {
-           if (srcNI==dstNI) continue;
-           TIntPr key(srcNI.GetKey(), dstNI.GetKey());
-           if (dstNI.GetDat().Tm <= data.time)
-              potentialEdges.AddDat(key, 1.0);
-        } 
-     }
-  }
+  if (!edgeSchedule.IsBuilt()) edgeSchedule.Build(data.cascades, minCoOccurrence);
+  edgeSchedule.Activate(data.time, potentialEdges);
+  compiledCascades.Compile(data, potentialEdges, shapingFunction, observedWindow, sparseSurvival);
 }
 
 void MMRateFunction::maximize() {
@@ -209,7 +191,7 @@ void MMRateParameter::set(MMRateFunctionConfigure configure) {
 
    TRnd rnd; rnd.PutSeed(time(NULL));
    for (TInt i=0;i<latentVariableSize;i++) {
-      kAlphas.AddDat(i, THash<TIntPr, TFlt>());
+      kAlphas.AddDat(i, EdgeAlphas());
       kPi.AddDat(i,rnd.GetUniDev() * 1.0 + 1.0);
       kPi_times.AddDat(i,0.0);
    }
@@ -220,7 +202,8 @@ void MMRateParameter::set(MMRateFunctionConfigure configure) {
 
 void MMRateParameter::reset() {
    diffusionPatterns.Clr();
-   for (THash<TInt, THash<TIntPr,TFlt> >::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
+   kMoments.Clr();
+   for (THash<TInt, EdgeAlphas>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
       AI.GetDat().Clr();
    }
    for (THash<TInt,TFlt>::TIter piI = kPi.BegI(); !piI.IsEnd(); piI++) { 
@@ -252,22 +235,15 @@ MMRateParameter& MMRateParameter::operator += (const MMRateParameter& p) {
       if (!diffusionPatterns.IsKey(key)) diffusionPatterns.AddDat(key, diffusionPattern);
       else diffusionPatterns.GetDat(key) += diffusionPattern;
    }
-   for(THash<TInt, THash<TIntPr, TFlt> >::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+   for(THash<TInt, EdgeAlphas>::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
       TInt key = AI.GetKey();
       if (!kAlphas.IsKey(key)) {
-         kAlphas.AddDat(key, THash<TIntPr, TFlt>());
+         kAlphas.AddDat(key, EdgeAlphas());
          kPi.AddDat(key, 0.0);
          kPi_times.AddDat(key, 0.0);
       }
 
-      THash<TIntPr, TFlt>& alphas = kAlphas.GetDat(key);
-      for (THash<TIntPr,TFlt>::TIter aI = AI.GetDat().BegI(); !aI.IsEnd(); aI++) {
-         TIntPr alphaIndex = aI.GetKey();
-         TFlt alpha = aI.GetDat();
-         if (!alphas.IsKey(alphaIndex)) alphas.AddDat(alphaIndex, alpha);
-         else alphas.GetDat(alphaIndex) += alpha;
-         //printf("topic: %d, %d,%d: += alpha:%f\n", key(), alphaIndex.Val1(), alphaIndex.Val2(), aI.GetDat());
-      }
+      kAlphas.GetDat(key) += AI.GetDat();
       
       kPi.GetDat(key) += p.kPi.GetDat(key);
       kPi_times.GetDat(key) += p.kPi_times.GetDat(key);
@@ -276,9 +252,8 @@ MMRateParameter& MMRateParameter::operator += (const MMRateParameter& p) {
 }
 
 MMRateParameter& MMRateParameter::operator *= (const TFlt multiplier) {
-   for(THash<TInt, THash<TIntPr,TFlt> >::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
-      THash<TIntPr, TFlt>& alphas = AI.GetDat();
-      for (THash<TIntPr,TFlt>::TIter aI = alphas.BegI(); !aI.IsEnd(); aI++) aI.GetDat() *= multiplier;
+   for(THash<TInt, EdgeAlphas>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
+      AI.GetDat() *= multiplier;
    }
    for (THash<TInt,TFlt>::TIter DI = diffusionPatterns.BegI(); !DI.IsEnd(); DI++) {
       DI.GetDat() *= multiplier;
@@ -286,7 +261,7 @@ MMRateParameter& MMRateParameter::operator *= (const TFlt multiplier) {
    return *this;
 }
 
-MMRateParameter& MMRateParameter::projectedlyUpdateGradient(const MMRateParameter& p) {
+MMRateParameter& MMRateParameter::projectedlyUpdateGradient(const MMRateParameter& p, const Optimizer& optimizer) {
    for (THash<TInt,TFlt>::TIter DI = p.diffusionPatterns.BegI(); !DI.IsEnd(); DI++) {
       TInt key = DI.GetKey();
       TFlt diffusionPatternGradient = DI.GetDat(), diffusionPattern;
@@ -301,22 +276,22 @@ MMRateParameter& MMRateParameter::projectedlyUpdateGradient(const MMRateParamete
       if (!diffusionPatterns.IsKey(key)) diffusionPatterns.AddDat(key,diffusionPattern);
       else diffusionPatterns.GetDat(key) = diffusionPattern;
    }
-   for(THash<TInt, THash<TIntPr,TFlt> >::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+   for(THash<TInt, EdgeAlphas>::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
       TInt key = AI.GetKey();
-      THash<TIntPr,TFlt>& alphas = kAlphas.GetDat(key);
-      for (THash<TIntPr,TFlt>::TIter aI = AI.GetDat().BegI(); !aI.IsEnd(); aI++) {
-         TIntPr alphaIndex = aI.GetKey();
-         TFlt alphaGradient = aI.GetDat(), alpha;
-         if (alphas.IsKey(alphaIndex)) alpha = alphas.GetDat(alphaIndex); 
-         else alpha = InitAlpha;
+      EdgeAlphas& alphas = kAlphas.GetDat(key);
+      EdgeMoments& moments = kMoments.AddDat(key);
+      const EdgeAlphas& alphasGradient = AI.GetDat();
+      for (int i=0; i<alphasGradient.Len(); i++) {
+         TInt edgeId = alphasGradient.GetId(i);
+         TFlt alphaGradient = optimizer.GetStep(moments, edgeId, alphasGradient.GetDat(edgeId));
+         TFlt alpha = alphas.GetDat(edgeId, InitAlpha);
 
          alpha -= (alphaGradient + (Regularizer ? Mu : TFlt(0.0)) * alpha);
 
          if (alpha < Tol) alpha = Tol;
          if (alpha > MaxAlpha) alpha = MaxAlpha;
 
-         if (!alphas.IsKey(alphaIndex)) alphas.AddDat(alphaIndex, alpha);
-         else alphas.GetDat(alphaIndex) = alpha;
+         alphas.AddDat(edgeId, alpha);
       }
 
       TFlt old = kPi.GetDat(key) * kPi_times.GetDat(key);
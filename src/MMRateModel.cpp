@@ -1,13 +1,18 @@
 #include <MMRateModel.h>
+#include <AsyncNetworkWriter.h>
 
 void MMRateModel::LoadCascadesTxt(const TStr& InFNm) {
-   TFIn FIn(InFNm);
-   InfoPathFileIO::LoadCascadesTxt(FIn, CascH, nodeInfo);
+   InfoPathFileIO::LoadCascadesTxt(InFNm, CascH, nodeInfo);
+   CascStore.Pack(CascH, nodeInfo.NodeNmH);
+}
+
+void MMRateModel::LoadCascadesBin(const TStr& InFNm) {
+   CascH.Clr();
+   InfoPathFileIO::LoadCascadesBin(InFNm, CascStore, nodeInfo);
 }
 
 void MMRateModel::LoadGroundTruthTxt(const TStr& InFNm) {
-   TFIn FIn(InFNm);
-   InfoPathFileIO::LoadNetworkTxt(FIn, Network, nodeInfo);
+   InfoPathFileIO::LoadNetworkTxt(InFNm, Network, nodeInfo);
 }
 
 void MMRateModel::SaveInferred(const TStr& OutFNm) {
@@ -23,10 +28,8 @@ void MMRateModel::SaveDiffusionPatterns(const TStr& OutFNm) {
 }
 
 void MMRateModel::Init() {
-   for (THash<TInt, TNodeInfo>::TIter NI = nodeInfo.NodeNmH.BegI(); NI < nodeInfo.NodeNmH.EndI(); NI++) {
-      InferredNetwork.AddNode(NI.GetKey(), NI.GetDat().Name);
-      MaxNetwork.AddNode(NI.GetKey(), NI.GetDat().Name);
-   }
+   InferredNetwork.Clr();
+   MaxNetwork.Clr();
 }
 
 void MMRateModel::Infer(const TFltV& Steps, const TStr& OutFNm) {
@@ -43,28 +46,31 @@ void MMRateModel::Infer(const TFltV& Steps, const TStr& OutFNm) {
    } 
    lossFunction.set(mMRateFunctionConfigure);
    em.set(eMConfigure);
+   // nodes of the ground truth that are in no cascade go after the others
+   CascStore.AddNodes(nodeInfo.NodeNmH);
    TIntFltH CascadesPositions;
-   Data data = {nodeInfo.NodeNmH, CascH, CascadesPositions, 0.0};
+   Data data = {nodeInfo.NodeNmH, CascStore, CascadesPositions, 0.0};
    lossFunction.InitLatentVariable(data, eMConfigure);
    
    TSampling Sampling = eMConfigure.pGDConfigure.sampling;
    TStrV ParamSamplingV; eMConfigure.pGDConfigure.ParamSampling.SplitOnAllCh(';', ParamSamplingV);
 
+   AsyncNetworkWriter writer(InferredNetwork, MaxNetwork, nodeInfo.NodeNmH, OutFNm, mMRateFunctionConfigure.MinAlpha, Aging, BinaryEdges);
    for (int t=1; t<Steps.Len(); t++) {
       TIntFltH CascadesPositions;
-      for (int i=0; i<CascH.Len(); i++) {
-         if (CascH[i].LenBeforeT(Steps[t]) > 1 &&
+      for (int i=0; i<CascStore.Len(); i++) {
+         if (CascStore.GetLenBeforeT(i, Steps[t]) > 1 &&
             ( (Sampling!=WIN_SAMPLING && Sampling!=WIN_EXP_SAMPLING) ||
-              (Sampling==WIN_SAMPLING && (Steps[t]-CascH[i].GetMinTm()) <= ParamSamplingV[0].GetFlt()) ||
-              (Sampling==WIN_EXP_SAMPLING && (Steps[t]-CascH[i].GetMinTm()) <= ParamSamplingV[0].GetFlt()) )) {
-            CascadesPositions.AddDat(i) = CascH[i].GetMinTm();
+              (Sampling==WIN_SAMPLING && (Steps[t]-CascStore.GetMinTm(i)) <= ParamSamplingV[0].GetFlt()) ||
+              (Sampling==WIN_EXP_SAMPLING && (Steps[t]-CascStore.GetMinTm(i)) <= ParamSamplingV[0].GetFlt()) )) {
+            CascadesPositions.AddDat(i) = CascStore.GetMinTm(i);
          }
       }
-      Data data = {nodeInfo.NodeNmH, CascH, CascadesPositions, Steps[t]};
+      Data data = {nodeInfo.NodeNmH, CascStore, CascadesPositions, Steps[t]};
       lossFunction.initPotentialEdges(data);
       em.Optimize(lossFunction, data);
 
-      const THash<TInt, THash<TIntPr, TFlt> >& kAlphas = lossFunction.getParameter().kAlphas;
+      const THash<TInt, EdgeAlphas>& kAlphas = lossFunction.getParameter().kAlphas;
       const THash<TInt,TFlt>& kPi = lossFunction.getParameter().kPi;
 
       printf("MMRate prior probability\n");
@@ -72,42 +78,10 @@ void MMRateModel::Infer(const TFltV& Steps, const TStr& OutFNm) {
       printf("\n");
          
 
-      for (THash<TInt, THash<TIntPr, TFlt> >::TIter NI = kAlphas.BegI(); !NI.IsEnd(); NI++) {
-         TInt key = NI.GetKey();
-         const THash<TIntPr, TFlt>& alphas = NI.GetDat();
-         TStrFltFltHNEDNet& inferredNetwork = InferredNetwork;
-
-         TFOut FOut(OutFNm + TStr("_") + key.GetStr() + ".txt");
-
-         for (THash<TInt, TNodeInfo>::TIter NodeI = nodeInfo.NodeNmH.BegI(); NodeI < nodeInfo.NodeNmH.EndI(); NodeI++) {
-            FOut.PutStr(TStr::Fmt("%d,%s\n", NodeI.GetKey().Val, NodeI.GetDat().Name.CStr()));
-         }
-         FOut.PutStr("\n");
-
-         int i=0;
-         for (THash<TIntPr, TFlt>::TIter AI = alphas.BegI(); !AI.IsEnd(); AI++,i++) {
-            if (i%100000==0) printf("add kAlphas: %d, alphas length: %d, alpha index: %d\n", NI.GetKey()(),alphas.Len(),i);
-            TInt srcNId = AI.GetKey().Val1, dstNId = AI.GetKey().Val2;
- 
-            TFlt alpha = AI.GetDat();
-            if (inferredNetwork.IsEdge(srcNId, dstNId) && inferredNetwork.GetEDat(srcNId, dstNId).IsKey(Steps[t-1]) && 
-                alpha == inferredNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t-1]))
-               alpha = alpha * Aging;
-            
-            if (alpha <= mMRateFunctionConfigure.MinAlpha) continue;
-            if (!inferredNetwork.IsEdge(srcNId, dstNId)) inferredNetwork.AddEdge(srcNId, dstNId, TFltFltH());
-            if (!MaxNetwork.IsEdge(srcNId, dstNId)) MaxNetwork.AddEdge(srcNId, dstNId, TFltFltH());
- 
-            FOut.PutStr(TStr::Fmt("%d,%d,%f,%f\n", srcNId, dstNId, Steps[t], alpha));
-
-            if (!inferredNetwork.GetEDat(srcNId, dstNId).IsKey(Steps[t])) inferredNetwork.GetEDat(srcNId,dstNId).AddDat(Steps[t]) = alpha * kPi.GetDat(key);
-            else InferredNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t]) += alpha * kPi.GetDat(key);
-
-            if (!MaxNetwork.GetEDat(srcNId, dstNId).IsKey(Steps[t])) MaxNetwork.GetEDat(srcNId,dstNId).AddDat(Steps[t]) = alpha;
-            else if (MaxNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t]) < alpha) MaxNetwork.GetEDat(srcNId, dstNId).GetDat(Steps[t]) = alpha;
-         }
-      }   
+      for (THash<TInt, EdgeAlphas>::TIter NI = kAlphas.BegI(); !NI.IsEnd(); NI++) writer.AddTopic(NI.GetKey(), kPi.GetDat(NI.GetKey()), NI.GetDat(), lossFunction.potentialEdges);
+      writer.Write(Steps[t], Steps[t-1]);
    }
+   writer.Wait();
    InfoPathFileIO::SaveNetwork(OutFNm + "_Max.txt", MaxNetwork, nodeInfo, edgeInfo);
    delete mMRateFunctionConfigure.shapingFunction;
 }
@@ -1,24 +1,28 @@
 #include <MixCascadesFunction.h>
 
 TFlt MixCascadesFunction::JointLikelihood(Datum datum, TInt latentVariable) const {
-   TFlt logP = -1 * parameter.kAlphas.GetDat(latentVariable).loss(datum);
+   TFlt logP = -1 * additiveRiskFunction.loss(datum, parameter.kAlphas.GetDat(latentVariable));
    TFlt logPi = TMath::Log(parameter.kPi.GetDat(latentVariable));
    //printf("logP: %f, logPi=%f\n",logP(),logPi());
    return logP + logPi;
 }
 
-MixCascadesParameter& MixCascadesFunction::gradient(Datum datum) {
-   parameter.reset();
-
-   for (THash<TInt,AdditiveRiskFunction>::TIter AI = parameter.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+void MixCascadesFunction::gradient(Datum datum, MixCascadesParameter& grad) const {
+   for (THash<TInt,AdditiveRiskParameter>::TIter AI = parameter.kAlphas.BegI(); !AI.IsEnd(); AI++) {
       TInt key = AI.GetKey();
-      AdditiveRiskParameter& alphas = AI.GetDat().gradient(datum);
-      alphas *= latentDistributions.GetDat(datum.index).GetDat(key);
-      //printf("index:%d, k:%d, latent distribution:%f\n",datum.index(), key(), latentDistributions.GetDat(datum.index).GetDat(key)());     
-      parameterGrad.kPi.GetDat(key) += latentDistributions.GetDat(datum.index).GetDat(key);
+      AdditiveRiskParameter& alphas = grad.kAlphas.AddDat(key);
+      additiveRiskFunction.gradient(datum, AI.GetDat(), alphas);
+      alphas *= GetLatentProbability(datum, key);
+      //printf("index:%d, k:%d, latent distribution:%f\n",datum.index(), key(), GetLatentProbability(datum, key)());     
+   }
+}
+
+void MixCascadesFunction::accumulateStatistics(Datum datum) {
+   for (THash<TInt,TFlt>::TIter PI = parameterGrad.kPi.BegI(); !PI.IsEnd(); PI++) {
+      TInt key = PI.GetKey();
+      PI.GetDat() += GetLatentProbability(datum, key);
       parameterGrad.kPi_times.GetDat(key)++; 
    }
-   return parameter;
 }
 
 void MixCascadesFunction::maximize() {
@@ -32,9 +36,7 @@ void MixCascadesFunction::maximize() {
 }
 
 void MixCascadesFunction::initPotentialEdges(Data data) {
-  for (THash<TInt,AdditiveRiskFunction>::TIter AI = parameter.kAlphas.BegI(); !AI.IsEnd(); AI++) {
-     AI.GetDat().initPotentialEdges(data);
-  }
+  additiveRiskFunction.initPotentialEdges(data);
 }
 
 void MixCascadesFunction::init(TInt latentVariableSize) {
@@ -44,6 +46,7 @@ void MixCascadesFunction::init(TInt latentVariableSize) {
 
 void MixCascadesFunction::set(MixCascadesFunctionConfigure configure) {
    latentVariableSize = configure.latentVariableSize;
+   additiveRiskFunction.set(configure.configure);
    parameter.set(configure);
 }
 
@@ -52,14 +55,14 @@ void MixCascadesFunction::initKPiParameter() {
 }
 
 void MixCascadesParameter::set(MixCascadesFunctionConfigure configure) {
-   for (THash<TInt,AdditiveRiskFunction>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
+   for (THash<TInt,AdditiveRiskParameter>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
       AI.GetDat().set(configure.configure);
    }
 }
 
 void MixCascadesParameter::init(TInt latentVariableSize) {
    for (TInt i=0; i<latentVariableSize; i++) {
-      kAlphas.AddDat(i,AdditiveRiskFunction());
+      kAlphas.AddDat(i,AdditiveRiskParameter());
       kPi.AddDat(i, 1.0 / double(latentVariableSize));
       kPi_times.AddDat(i, 0.0);
    }
@@ -77,8 +80,8 @@ void MixCascadesParameter::initKPiParameter() {
 
 
 void MixCascadesParameter::reset() {
-   for (THash<TInt,AdditiveRiskFunction>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
-      AI.GetDat().parameterGrad.reset();
+   for (THash<TInt,AdditiveRiskParameter>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
+      AI.GetDat().reset();
    }
 }
 
@@ -94,27 +97,27 @@ MixCascadesParameter& MixCascadesParameter::operator = (const MixCascadesParamet
 }
 
 MixCascadesParameter& MixCascadesParameter::operator += (const MixCascadesParameter& p) {
-   for(THash<TInt,AdditiveRiskFunction>::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+   for(THash<TInt,AdditiveRiskParameter>::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
       TInt key = AI.GetKey();
       if (!kAlphas.IsKey(key)) {
-         kAlphas.AddDat(key,AdditiveRiskFunction());
+         kAlphas.AddDat(key,AdditiveRiskParameter());
       }
-      kAlphas.GetDat(key).parameter += AI.GetDat().parameterGrad;
+      kAlphas.GetDat(key) += AI.GetDat();
    }
    return *this;
 }
 
 MixCascadesParameter& MixCascadesParameter::operator *= (const TFlt multiplier) {
-   for(THash<TInt,AdditiveRiskFunction>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
-      AI.GetDat().parameter *= multiplier;
+   for(THash<TInt,AdditiveRiskParameter>::TIter AI = kAlphas.BegI(); !AI.IsEnd(); AI++) {
+      AI.GetDat() *= multiplier;
    }
    return *this;
 }
 
-MixCascadesParameter& MixCascadesParameter::projectedlyUpdateGradient(const MixCascadesParameter& p) {
-   for(THash<TInt,AdditiveRiskFunction>::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
+MixCascadesParameter& MixCascadesParameter::projectedlyUpdateGradient(const MixCascadesParameter& p, const Optimizer& optimizer) {
+   for(THash<TInt,AdditiveRiskParameter>::TIter AI = p.kAlphas.BegI(); !AI.IsEnd(); AI++) {
       TInt key = AI.GetKey();
-      kAlphas.GetDat(key).parameter.projectedlyUpdateGradient(AI.GetDat().parameter);
+      kAlphas.GetDat(key).projectedlyUpdateGradient(AI.GetDat(), optimizer);
    }
    return *this;
 }
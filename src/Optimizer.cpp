@@ -0,0 +1,60 @@
+#include <Optimizer.h>
+#include <cmath>
+
+const double Optimizer::Beta1 = 0.9;
+const double Optimizer::Beta2 = 0.999;
+const double Optimizer::Decay = 0.9;
+const double Optimizer::Eps = 1e-8;
+
+void EdgeMoments::Reserve(const int edgeNm) {
+   if (second.Len() >= edgeNm) return;
+   // doubling, the new entries start at 0
+   int len = TMath::Mx(edgeNm, 2 * second.Len());
+   first.Reserve(len);
+   second.Reserve(len);
+   while (second.Len() < len) { first.Add(0.0); second.Add(0.0); }
+}
+
+void Optimizer::set(const TOptimizer optimizerType, const double rate) {
+   type = optimizerType;
+   learningRate = rate;
+   stepNm = 0;
+   firstCorrection = secondCorrection = 1.0;
+}
+
+void Optimizer::NextStep() {
+   stepNm++;
+   if (type == ADAM_OPTIMIZER) {
+      firstCorrection = 1.0 - pow(Beta1, stepNm);
+      secondCorrection = 1.0 - pow(Beta2, stepNm);
+   }
+}
+
+// Edges only get moments when they are in a gradient, so the Adam moments are
+// updated lazily, with the bias correction of the global step.
+double Optimizer::GetStep(EdgeMoments& moments, const int edgeId, const double scaledGradient) const {
+   if (type == SGD_OPTIMIZER || learningRate == 0.0) return scaledGradient;
+
+   const double gradient = scaledGradient / learningRate;
+   moments.Reserve(edgeId + 1);
+   TFlt& first = moments.first[edgeId];
+   TFlt& second = moments.second[edgeId];
+
+   switch (type) {
+      case ADAGRAD_OPTIMIZER:
+         second += gradient * gradient;
+         return learningRate * gradient / (sqrt(second) + Eps);
+
+      case RMSPROP_OPTIMIZER:
+         second = Decay * second + (1.0 - Decay) * gradient * gradient;
+         return learningRate * gradient / (sqrt(second) + Eps);
+
+      case ADAM_OPTIMIZER:
+         first = Beta1 * first + (1.0 - Beta1) * gradient;
+         second = Beta2 * second + (1.0 - Beta2) * gradient * gradient;
+         return learningRate * (first / firstCorrection) / (sqrt(second / secondCorrection) + Eps);
+
+      default:
+         return scaledGradient;
+   }
+}
@@ -0,0 +1,143 @@
+#include <ResultWriter.h>
+#include <cstring>
+
+ResultWriter::ResultWriter(const TStr& OutFNm, const bool binaryEdges, const bool append) : binFile(NULL), bfLen(0), records(NULL), recordNm(0) {
+   file = fopen(OutFNm.CStr(), append ? "ab" : "wb");
+   EAssertR(file != NULL, TStr::Fmt("Can not open %s for writing", OutFNm.CStr()));
+   bf = new char[BfL];
+
+   if (binaryEdges) {
+      TStr BinFNm = OutFNm + ".bin";
+      binFile = fopen(BinFNm.CStr(), append ? "ab" : "wb");
+      EAssertR(binFile != NULL, TStr::Fmt("Can not open %s for writing", BinFNm.CStr()));
+      records = new EdgeRecord[RecordBfL];
+   }
+}
+
+ResultWriter::~ResultWriter() {
+   Flush();
+   fclose(file);
+   if (binFile != NULL) fclose(binFile);
+   delete[] bf;
+   delete[] records;
+}
+
+void ResultWriter::PutStr(const char *str) {
+   int len = strlen(str);
+   if (len > BfL) {
+      Flush();
+      fwrite(str, 1, len, file);
+      return;
+   }
+   Reserve(len);
+   memcpy(bf + bfLen, str, len);
+   bfLen += len;
+}
+
+void ResultWriter::PutInt(const int val) {
+   Reserve(12);
+   unsigned int uval = val < 0 ? 0u - (unsigned int)val : (unsigned int)val;
+   if (val < 0) bf[bfLen++] = '-';
+
+   char digits[10];
+   int digitNm = 0;
+   do { digits[digitNm++] = '0' + uval % 10; uval /= 10; } while (uval > 0);
+   while (digitNm > 0) bf[bfLen++] = digits[--digitNm];
+}
+
+// Six decimals as "%f", rounded the way printf rounds: on the exact value of
+// val*1e6, to nearest and ties to even. Sign, exponent and mantissa are read
+// from the bits of val, so the scaled value is an exact 128-bit fraction and
+// neither floating point rounding nor -ffast-math (which drops nan checks and
+// the sign of -0.0) can change the output. Magnitudes of 2^32 or more, and
+// nan/inf, go through snprintf.
+void ResultWriter::PutFlt(const double val) {
+   uint64 bits;
+   memcpy(&bits, &val, sizeof(bits));
+   const int biasedExponent = int((bits >> 52) & 0x7ff);
+
+   // |val| = mantissa * 2^exponent exactly
+   const uint64 mantissa = (bits & 0xfffffffffffffULL) | (biasedExponent > 0 ? 1ULL << 52 : 0);
+   const int exponent = (biasedExponent > 0 ? biasedExponent : 1) - 1075;
+   if (exponent > -21) {
+      Reserve(352);
+      bfLen += snprintf(bf + bfLen, 352, "%f", val);
+      return;
+   }
+
+   // units < 2^32 * 1e6, so six digits of fraction and at most ten of integer
+   const unsigned __int128 scaled = (unsigned __int128)mantissa * 1000000u;
+   const int shift = -exponent;
+   uint64 units = 0;
+   if (shift < 100) {
+      // else scaled < 2^73 is below half a unit and rounds to 0
+      units = (uint64)(scaled >> shift);
+      const unsigned __int128 rest = scaled & ((((unsigned __int128)1) << shift) - 1);
+      const unsigned __int128 half = ((unsigned __int128)1) << (shift - 1);
+      if (rest > half || (rest == half && (units & 1))) units++;
+   }
+
+   Reserve(24);
+   if (bits >> 63) bf[bfLen++] = '-';
+
+   uint64 intPart = units / 1000000;
+   int fracPart = int(units % 1000000);
+   char digits[20];
+   int digitNm = 0;
+   do { digits[digitNm++] = '0' + intPart % 10; intPart /= 10; } while (intPart > 0);
+   while (digitNm > 0) bf[bfLen++] = digits[--digitNm];
+
+   bf[bfLen++] = '.';
+   for (int i=5; i>=0; i--) { bf[bfLen+i] = '0' + fracPart % 10; fracPart /= 10; }
+   bfLen += 6;
+}
+
+void ResultWriter::PutNodes(const THash<TInt, TNodeInfo>& NodeNmH, const char *lineEnd) {
+   for (THash<TInt, TNodeInfo>::TIter NI = NodeNmH.BegI(); NI < NodeNmH.EndI(); NI++) {
+      PutInt(NI.GetKey());
+      PutCh(',');
+      PutStr(NI.GetDat().Name);
+      PutStr(lineEnd);
+   }
+   PutStr(lineEnd);
+}
+
+void ResultWriter::PutEdge(const int srcNId, const int dstNId, const double time, const double alpha) {
+   PutInt(srcNId);
+   PutCh(',');
+   PutInt(dstNId);
+   PutCh(',');
+   PutFlt(time);
+   PutCh(',');
+   PutFlt(alpha);
+   PutCh('\n');
+
+   if (binFile == NULL) return;
+   if (recordNm == RecordBfL) Flush();
+   EdgeRecord& record = records[recordNm++];
+   record.srcNId = srcNId;
+   record.dstNId = dstNId;
+   record.time = time;
+   record.alpha = alpha;
+}
+
+void ResultWriter::PutCascade(const TCascade& C, const THash<TInt, TNodeInfo>& NodeNmH) {
+   int j = 0;
+   for (THash<TInt, THitInfo>::TIter NI = C.NIdHitH.BegI(); NI < C.NIdHitH.EndI(); NI++) {
+      if (!NodeNmH.IsKey(NI.GetDat().NId)) continue;
+      if (j > 0) { PutCh(','); }
+      else { PutInt(C.CId); PutCh(';'); }
+      PutInt(NI.GetDat().NId);
+      PutCh(',');
+      PutFlt(NI.GetDat().Tm);
+      j++;
+   }
+   if (j >= 1) PutStr("\r\n");
+}
+
+void ResultWriter::Flush() {
+   if (bfLen > 0) fwrite(bf, 1, bfLen, file);
+   bfLen = 0;
+   if (recordNm > 0) fwrite(records, sizeof(EdgeRecord), recordNm, binFile);
+   recordNm = 0;
+}
@@ -0,0 +1,41 @@
+#include <TemporalNetwork.h>
+
+int TemporalNetwork::AddStep(const double time) {
+   if (!steps.Empty() && steps.Last() == time) return steps.Len() - 1;
+   IAssert(steps.Empty() || steps.Last() < time);
+   stepIdxH.AddDat(time, steps.Len());
+   steps.Add(time);
+   alphas.Add();
+   return steps.Len() - 1;
+}
+
+int TemporalNetwork::GetStepIdx(const double time) const {
+   int keyId = stepIdxH.GetKeyId(time);
+   if (keyId == -1) return -1;
+   return stepIdxH[keyId];
+}
+
+// Edge ids follow the edge order of Network.
+void TemporalNetwork::FromNetwork(const TStrFltFltHNEDNet& Network) {
+   Clr();
+
+   TFltV times;
+   for (TStrFltFltHNEDNet::TEdgeI EI = Network.BegEI(); EI < Network.EndEI(); EI++) {
+      for (int i=0; i<EI().Len(); i++) times.Add(EI().GetKey(i));
+   }
+   times.Sort();
+   times.Merge();
+   for (int i=0; i<times.Len(); i++) AddStep(times[i]);
+
+   for (TStrFltFltHNEDNet::TEdgeI EI = Network.BegEI(); EI < Network.EndEI(); EI++) {
+      TInt edgeId = AddEdge(EI.GetSrcNId(), EI.GetDstNId());
+      for (int i=0; i<EI().Len(); i++) AddDat(GetStepIdx(EI().GetKey(i)), edgeId, EI()[i]);
+   }
+}
+
+void TemporalNetwork::Clr() {
+   steps.Clr();
+   stepIdxH.Clr();
+   edges.Clr();
+   alphas.Clr();
+}